@@ -0,0 +1,38 @@
+"""
+Per-op dispatch overhead, measured in C++.
+
+The other benchmarks in this directory go through Python, so changes to the
+framework overhead in DynamicLayer.cpp, the generated plumbing, or the
+sliced fallback are invisible beneath Python noise. This driver calls into
+functorch._C._dispatch_overhead_benchmarks, which times the dispatch paths
+from C++ (see NOTE: [Dispatch overhead microbenchmarks]) and reports ns/op
+for:
+- pushing and popping a dynamic layer
+- a vmapped add through the generated plumbing at nesting depths 1-3
+- an add on a grad-wrapped tensor
+- one slice iteration of the for-loop vmap fallback
+
+Track these numbers across releases the same way we track model QPS.
+"""
+import argparse
+
+import torch  # noqa: F401
+
+from functorch._C import _dispatch_overhead_benchmarks
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--iters", type=int, default=100000,
+                        help="iterations per benchmark")
+    args = parser.parse_args()
+
+    torch.set_num_threads(1)
+    results = _dispatch_overhead_benchmarks(args.iters)
+    width = max(len(name) for name in results)
+    for name, ns_per_op in results.items():
+        print(f"{name:<{width}}  {ns_per_op:10.1f} ns/op")
+
+
+if __name__ == "__main__":
+    main()
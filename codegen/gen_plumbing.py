@@ -27,18 +27,28 @@ def gen_args_list(args_t):
     return ', '.join(args)
 
 
+def split_op_and_variant(op):
+    maybe_op_and_variant = op.split('.')
+    if len(maybe_op_and_variant) == 1:
+        return maybe_op_and_variant[0], '', maybe_op_and_variant[0]
+    op, variant = maybe_op_and_variant
+    return op, variant, f'{op}_{variant}'
+
+
+def get_plain_tensor_args(args_t):
+    # Plain `Tensor` args only: optionals and TensorLists would need the
+    # boxed fallback's foreachTensorInplace pass anyway, so the fast path
+    # doesn't try to inspect them.
+    return [argname for typ, argname in args_t
+            if 'Tensor' in typ and 'List' not in typ
+            and 'optional' not in typ and '[]' not in typ]
+
+
 def gen_plumbing(signature):
     # "add.Tensor"
     op, return_t, args_t = signature
 
-    maybe_op_and_variant = op.split('.')
-    if len(maybe_op_and_variant) == 1:
-        op = maybe_op_and_variant[0]
-        variant = ''
-        opname = op
-    else:
-        op, variant = maybe_op_and_variant
-        opname = f'{op}_{variant}'
+    op, variant, opname = split_op_and_variant(op)
 
     if op.endswith('_'):
         raise ValueError('Codegen doesn\'t handle in-place ops')
@@ -64,6 +74,49 @@ def gen_plumbing(signature):
     return result
 
 
+def gen_front_fastpath(signature):
+    # Emits an unboxed fast path that gets registered at the dynamic layer
+    # front mode key. For the common case -- exactly one transform layer
+    # (vmap) and no grad wrappers among the args -- every op otherwise pays
+    # for two boxed dispatcher round trips: front fallback, then re-dispatch
+    # to the plumbing at kBatchedKey. The fast path enters the layer's TLS
+    # key sets inline and calls the plumbing directly; anything else bails
+    # into the boxed front fallback, which handles the general case.
+    op, return_t, args_t = signature
+
+    op, variant, opname = split_op_and_variant(op)
+
+    tensor_args = get_plain_tensor_args(args_t)
+    if tensor_args:
+        wrapper_check = (
+            f' &&\n          !anyTensorIsGradWrapped({{ {", ".join(tensor_args)} }})')
+    else:
+        wrapper_check = ''
+
+    result = deindent(f"""\
+    {gen_return_sig(return_t)} {opname}_front_fastpath({gen_args_sig(args_t)}) {{
+      const auto& dynamic_layer_stack = getDynamicLayerStack();
+      // Level 1 is always the sentinel Autograd layer, so "exactly one
+      // transform layer" means a stack of size 2 with vmap on top.
+      if (dynamic_layer_stack.size() == 2 &&
+          dynamic_layer_stack.back().key() == kBatchedKey{wrapper_check}) {{
+        DynamicLayerKeySetGuard guard(kBatchedKey);
+        return {opname}_plumbing({gen_args_list(args_t)});
+      }}
+      static auto op = c10::Dispatcher::singleton()
+        .findSchemaOrThrow("aten::{op}", "{variant}");
+      return front_fallback<{','.join(return_t)}>(op, {{ {gen_args_list(args_t)} }});
+    }}
+
+    // Register at the front mode key so the dispatcher calls the fast path
+    // directly instead of the boxed fallback:
+    // TORCH_LIBRARY_IMPL(aten, FT_DYNAMIC_LAYER_FRONT_MODE_KEY, m) {{
+    //   m.impl("{op}{'.' + variant if variant else ''}", {opname}_front_fastpath);
+    // }}
+    """)
+    return result
+
+
 if __name__ == '__main__':
     parser = argparse.ArgumentParser(
         description='Generate the batch rule plumbing for an op')
@@ -76,5 +129,5 @@ if __name__ == '__main__':
     # gen_plumbing.py add.Tensor ~/pytorch/build/aten/src/ATen/RegistrationDeclarations.h
     args = parser.parse_args()
     signature = get_signature(args.op, args.path)
-    result = gen_plumbing(signature)
-    print(result)
+    print(gen_plumbing(signature))
+    print(gen_front_fastpath(signature))
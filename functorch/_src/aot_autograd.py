@@ -1,3 +1,8 @@
+import hashlib
+import inspect
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
 import torch
 import torch.nn as nn
 from torch import Tensor
@@ -125,12 +130,13 @@ def create_aot_autograd_function(
 
     compiled_fw = None
     compiled_bw = None
+    compiled_bw_future = None
     num_outs = None
 
     class CompiledFunction(torch.autograd.Function):
         @staticmethod
         def forward(ctx, *flat_tensor_args):
-            nonlocal compiled_fw, compiled_bw, num_outs
+            nonlocal compiled_fw, compiled_bw_future, num_outs
             if compiled_fw is None:
                 with torch.set_grad_enabled(grad_state):
                     out = flat_fn(*flat_tensor_args)
@@ -156,7 +162,18 @@ def create_aot_autograd_function(
                 fw_outs = normalize_as_list(compiled_fw(*flat_tensor_args))
 
                 bw_args = fw_outs[num_outs:] + fw_outs[0:num_outs]
-                compiled_bw = bw_compiler(bw_module, bw_args)
+                # NOTE: [Deferred backward compilation]
+                # The backward compilation only depends on bw_module and the
+                # shapes of fw_outs, so there is no reason to block the first
+                # forward on it. Hand it to the compile worker and only wait
+                # for the result at the first backward: first-call latency
+                # approaches max(fw, bw) instead of fw + bw, and inference-only
+                # sessions never pay for the backward at all. The tradeoff is
+                # that a bw_compiler error surfaces at the first backward
+                # rather than the first forward.
+                compiled_bw_future = _get_async_compile_executor().submit(
+                    bw_compiler, bw_module, bw_args
+                )
             else:
                 fw_outs = normalize_as_list(compiled_fw(*flat_tensor_args))
             ctx.save_for_backward(*fw_outs[num_outs:])
@@ -164,6 +181,11 @@ def create_aot_autograd_function(
 
         @staticmethod
         def backward(ctx, *flat_args):
+            nonlocal compiled_bw, compiled_bw_future
+            if compiled_bw is None:
+                # See NOTE: [Deferred backward compilation]
+                compiled_bw = compiled_bw_future.result()
+                compiled_bw_future = None
             # hmm... this doesn't feel right. todo
             # contiguous_args = [t.contiguous() for t in flat_args]
             contiguous_args = [t for t in flat_args]
@@ -187,6 +209,60 @@ except ImportError:
 compile_cache = None
 
 
+# NOTE: [Stable cache ids]
+# The compile cache key embeds ids for fn and both compilers. id() is a
+# per-process pointer, so keys built from it can never hit after a
+# save_compile_cache/load_compile_cache round trip into another process.
+# Derive a deterministic id from the callable's qualified name and source
+# text instead; fall back to id() when the source is unavailable (builtins,
+# C extensions), which keeps in-process caching working but makes those
+# entries non-portable.
+def _stable_callable_id(obj) -> int:
+    # Two closures built from the same source can capture different values
+    # and compute different things; source text alone would alias them, so
+    # they keep per-process ids (and don't warm-start).
+    if getattr(obj, "__closure__", None):
+        return id(obj)
+    try:
+        source = inspect.getsource(obj)
+    except (OSError, TypeError):
+        return id(obj)
+    qualname = getattr(obj, "__qualname__", type(obj).__qualname__)
+    digest = hashlib.sha1((qualname + source).encode("utf-8")).digest()
+    # Clear the sign bit: the C++ side takes int64_t ids.
+    return int.from_bytes(digest[:8], "little") & 0x7FFFFFFFFFFFFFFF
+
+
+def _stable_str_hash(s: str) -> int:
+    # hash() of a str is salted per-process (PYTHONHASHSEED); use this for
+    # values that participate in persisted cache keys.
+    digest = hashlib.sha1(s.encode("utf-8")).digest()
+    return int.from_bytes(digest[:8], "little") & 0x7FFFFFFFFFFFFFFF
+
+
+# NOTE: [Async compilation]
+# With async_compile=True, a cache miss in aot_function enqueues the
+# trace+compile work to a background thread and serves the request with the
+# plain Python function, so new shape buckets don't show up as multi-second
+# latency spikes on the request thread. The pending set dedupes in-flight
+# keys; racing inserts for the same key are already harmless on the C++
+# side. One worker is enough: compilation throughput is not the point,
+# keeping it off the request thread is.
+_async_compile_executor = None
+_async_compile_lock = threading.Lock()
+_async_compile_pending = set()
+
+
+def _get_async_compile_executor():
+    global _async_compile_executor
+    with _async_compile_lock:
+        if _async_compile_executor is None:
+            _async_compile_executor = ThreadPoolExecutor(
+                max_workers=1, thread_name_prefix="functorch_compile"
+            )
+        return _async_compile_executor
+
+
 # Inspired by autodidax (thanks!)
 class PytreeThunk:
     spec = None
@@ -270,6 +346,7 @@ def aot_function(
     decompositions: Dict = {},
     hasher_type: str = "StaticShapeHasher",
     static_argnums: Optional[Tuple[int]] = None,
+    async_compile: bool = False,
 ) -> Callable:
     """
     Returns a function that behaves like the original :attr:`func`, but
@@ -308,8 +385,28 @@ def aot_function(
             backward graphs.
         decompositions (Dict): A dictionary to define the decomposition of
             larger Aten ops into simpler or core Aten ops.
+        hasher_type (str): The input-tensor properties the compilation cache
+            keys on. "StaticShapeHasher" recompiles per exact shape and
+            stride. "DynamicShapeHasher" keys on rank, contiguity and
+            broadcasting but not sizes. "BucketedShapeHasher" buckets sizes
+            by configurable boundaries (set via
+            ``functorch._C._compile_cache_set_shape_bucket_boundaries``;
+            powers of two past the configured list) so one compiled kernel
+            serves a whole bucket with no recompiles inside it; the
+            compilers must then read sizes and strides from their inputs at
+            runtime instead of baking them in.
+            Default: "StaticShapeHasher"
         static_argnums (Optional[Tuple[Int]]): An option tuple of ints to mark
             the arguments of the function as static.
+        async_compile (bool): If True, a cache miss compiles on a background
+            thread while the call is served by running :attr:`fn` directly;
+            the compiled version is used once it is ready. Useful for
+            latency-sensitive services where a new input shape must not
+            stall the request that first sees it. The background warm-up
+            traces and runs :attr:`fn` once more on a worker thread, so
+            :attr:`fn` must be safe to re-execute concurrently off the
+            calling thread (pure functions are; functions with side
+            effects may not be). Default: False
 
     Returns:
         Returns a ``Callable`` that retains the eager behavior of the original
@@ -343,9 +440,10 @@ def aot_function(
         bw_compiler = fw_compiler
     cached_res = None
 
-    fn_id = id(fn)
-    fw_compiler_id = id(fw_compiler)
-    bw_compiler_id = id(bw_compiler)
+    # See NOTE: [Stable cache ids]
+    fn_id = _stable_callable_id(fn)
+    fw_compiler_id = _stable_callable_id(fw_compiler)
+    bw_compiler_id = _stable_callable_id(bw_compiler)
 
     if isinstance(static_argnums, int):
         static_argnums = [static_argnums]
@@ -391,6 +489,7 @@ def aot_function(
 
         # Compile the function and save it in the cache
         if cached_res is None:
+            grad_state = torch.is_grad_enabled()
             # Save the args_spec for flat_tensor_args to unflatten while tracing
             _, tensor_args_spec = pytree.tree_flatten((tensor_args, kwargs))
             out_spec = PytreeThunk()
@@ -426,21 +525,159 @@ def aot_function(
                 out_spec.set(spec)
                 return flat_out
 
-            compiled_fn = create_aot_autograd_function(
-                flat_fn,
-                fw_compiler,
-                bw_compiler,
-                partition_fn,
-                decompositions,
-                grad_state=torch.is_grad_enabled(),
-            ).apply
-            cached_res = (compiled_fn, out_spec)
+            def build_compiled():
+                compiled_fn = create_aot_autograd_function(
+                    flat_fn,
+                    fw_compiler,
+                    bw_compiler,
+                    partition_fn,
+                    decompositions,
+                    grad_state=grad_state,
+                ).apply
+                return (compiled_fn, out_spec)
+
+            def insert_in_cache(res):
+                compile_cache.insert(
+                    fn_id,
+                    fw_compiler_id,
+                    bw_compiler_id,
+                    num_tensor_args,
+                    hasher_type,
+                    res,
+                    *flat_args_for_cache,
+                )
+
+            if async_compile:
+                # See NOTE: [Async compilation]. Tracking keys by tensor
+                # metadata over-specializes relative to DynamicShapeHasher,
+                # which at worst queues a duplicate compile; insert() is
+                # race-free.
+                pending_key = (
+                    fn_id,
+                    fw_compiler_id,
+                    bw_compiler_id,
+                    num_tensor_args,
+                    hasher_type,
+                    tuple(static_args_hashed),
+                    tuple(
+                        (a.shape, a.stride(), a.dtype, a.requires_grad)
+                        if isinstance(a, torch.Tensor)
+                        else None
+                        for a in flat_tensor_args
+                    ),
+                )
+                with _async_compile_lock:
+                    already_queued = pending_key in _async_compile_pending
+                    _async_compile_pending.add(pending_key)
+                if not already_queued:
+
+                    def compile_in_background():
+                        try:
+                            res = build_compiled()
+                            # Tracing and compilation are lazy; force them
+                            # here so the entry is only published once a hit
+                            # is actually cheap.
+                            res[0](*flat_tensor_args)
+                            insert_in_cache(res)
+                        finally:
+                            with _async_compile_lock:
+                                _async_compile_pending.discard(pending_key)
+
+                    _get_async_compile_executor().submit(compile_in_background)
+                # Serve this call interpreted while the kernel compiles.
+                return fn(*args, **kwargs)
+
+            cached_res = build_compiled()
+            insert_in_cache(cached_res)
+
+        cached_fn, out_spec = cached_res
+        out = cached_fn(*flat_tensor_args)
+        return out_spec.unflatten(out)
+
+    return returned_function
 
-            # Save the compiled_fn in the cache
+
+# NOTE: [Compiled vmap]
+# vmap re-runs the per-op plumbing (dynamicLayerFrontFallback plus a batch
+# rule lookup) on every call, even when the op sequence never changes. For a
+# fixed model it is enough to apply the batch rules once: tracing vmap(fn)
+# with make_fx records the post-batch-rule primitives into an fx graph, and
+# replaying that graph involves no DynamicLayer machinery at all. Batched
+# graphs are specialized on input metadata and cached in the same
+# CompileCache (and counted by num_of_recompilations) as aot_function
+# results.
+def compiled_vmap(fn, in_dims=0, out_dims=0, fw_compiler=None,
+                  hasher_type="StaticShapeHasher"):
+    """
+    Returns a function that computes the same thing as
+    ``vmap(fn, in_dims, out_dims)`` but applies the batch rules symbolically,
+    once per input specialization: the resulting batched fx graph is cached
+    and on later calls is executed directly, with no per-op vmap dispatch.
+
+    ``fw_compiler`` is applied to the batched graph with the same calling
+    convention as :func:`aot_function` compilers; by default the traced graph
+    module itself is executed.
+    """
+    from .python_key import make_fx
+    from .vmap import vmap
+
+    global compile_cache
+    if compile_cache is None:
+        compile_cache = CompileCache()
+    if fw_compiler is None:
+        def fw_compiler(fx_g, inps):
+            return fx_g
+
+    batched_fn = vmap(fn, in_dims=in_dims, out_dims=out_dims)
+    # See NOTE: [Stable cache ids]
+    fn_id = _stable_callable_id(fn)
+    fw_compiler_id = _stable_callable_id(fw_compiler)
+    # in_dims/out_dims change the graph, so they participate in the cache key
+    # the same way hashed static args do.
+    dims_hash = _stable_str_hash(str(in_dims) + '|' + str(out_dims))
+
+    def returned_function(*args, **kwargs):
+        global compile_cache
+
+        if HAS_TREE:
+            flat_tensor_args = tree.flatten((args, kwargs))
+        else:
+            flat_tensor_args, _ = pytree.tree_flatten((args, kwargs))
+
+        num_tensor_args = len(flat_tensor_args)
+        flat_args_for_cache = flat_tensor_args + [dims_hash]
+        cached_res = compile_cache.at(
+            fn_id,
+            fw_compiler_id,
+            0,  # no backward compiler participates in the key
+            num_tensor_args,
+            hasher_type,
+            *flat_args_for_cache,
+        )
+
+        if cached_res is None:
+            _, tensor_args_spec = pytree.tree_flatten((args, kwargs))
+            out_spec = PytreeThunk()
+
+            def flat_batched_fn(*flat_args):
+                nonlocal out_spec
+                tensor_args, kwargs = pytree.tree_unflatten(
+                    flat_args, tensor_args_spec
+                )
+                tree_out = batched_fn(*tensor_args, **kwargs)
+                flat_out, spec = pytree.tree_flatten(tree_out)
+                out_spec.set(spec)
+                return flat_out
+
+            # Tracing runs vmap for real; the graph records the primitives
+            # the batch rules produced, not the vmapped op sequence.
+            fx_g = make_fx(flat_batched_fn)(*flat_tensor_args)
+            compiled_fn = fw_compiler(fx_g, flat_tensor_args)
+            cached_res = (compiled_fn, out_spec)
             compile_cache.insert(
                 fn_id,
                 fw_compiler_id,
-                bw_compiler_id,
+                0,
                 num_tensor_args,
                 hasher_type,
                 cached_res,
@@ -454,6 +691,121 @@ def aot_function(
     return returned_function
 
 
+# NOTE: [CUDA graph replay]
+# For small-batch work the CPU-side per-op machinery and kernel launch
+# overhead dominate; the kernel sequence a transformed function produces is
+# static for fixed shapes, which is exactly what CUDA graphs want. We
+# capture once per input specialization into static input buffers and
+# replay afterwards: each call copies the new inputs into the capture-time
+# buffers and launches the whole graph as one unit. Specializations reuse
+# the CompileCache (StaticShapeHasher keys on shape/stride/dtype, which
+# capture requires anyway).
+def _record_cuda_graph(run_fn, flat_args):
+    static_inputs = [
+        arg.clone() if isinstance(arg, torch.Tensor) else arg
+        for arg in flat_args
+    ]
+    # Warm up on a side stream first: capture forbids the lazy
+    # initialization (allocator pools, cuBLAS handles, autotuning) a first
+    # run triggers.
+    stream = torch.cuda.Stream()
+    stream.wait_stream(torch.cuda.current_stream())
+    with torch.cuda.stream(stream):
+        run_fn(*static_inputs)
+    torch.cuda.current_stream().wait_stream(stream)
+    torch.cuda.synchronize()
+
+    graph = torch.cuda.CUDAGraph()
+    with torch.cuda.graph(graph):
+        static_outputs = run_fn(*static_inputs)
+
+    def replay(*flat_args):
+        for dst, src in zip(static_inputs, flat_args):
+            if isinstance(dst, torch.Tensor) and dst.data_ptr() != src.data_ptr():
+                dst.copy_(src, non_blocking=True)
+        graph.replay()
+        return static_outputs
+
+    return replay
+
+
+def cudagraphify(fn, hasher_type="StaticShapeHasher"):
+    """
+    Returns a function that captures ``fn`` into a CUDA graph once per input
+    shape specialization and replays the graph on subsequent calls, copying
+    the new inputs into the capture-time buffers first. See
+    NOTE: [CUDA graph replay].
+
+    Restrictions are those of CUDA graph capture: all tensor inputs must be
+    CUDA tensors, shapes must be static per specialization, and ``fn`` must
+    not contain CPU synchronization or data-dependent control flow. The
+    returned outputs alias the graph's static buffers and are overwritten by
+    the next call; clone them to keep results across calls.
+    """
+    global compile_cache
+    if compile_cache is None:
+        compile_cache = CompileCache()
+    # See NOTE: [Stable cache ids]. CUDA graphs never persist across
+    # processes, but a stable id keeps the key scheme uniform.
+    fn_id = _stable_callable_id(fn)
+
+    def returned_function(*args, **kwargs):
+        global compile_cache
+
+        if HAS_TREE:
+            flat_tensor_args = tree.flatten((args, kwargs))
+        else:
+            flat_tensor_args, _ = pytree.tree_flatten((args, kwargs))
+
+        num_tensor_args = len(flat_tensor_args)
+        cached_res = compile_cache.at(
+            fn_id,
+            0,  # no compilers participate in the key
+            0,
+            num_tensor_args,
+            hasher_type,
+            *flat_tensor_args,
+        )
+
+        if cached_res is None:
+            for arg in flat_tensor_args:
+                if isinstance(arg, torch.Tensor) and not arg.is_cuda:
+                    raise RuntimeError(
+                        "cudagraphify: all tensor inputs must live on a CUDA "
+                        "device to be captured"
+                    )
+            _, tensor_args_spec = pytree.tree_flatten((args, kwargs))
+            out_spec = PytreeThunk()
+
+            def flat_fn(*flat_args):
+                nonlocal out_spec
+                tensor_args, kwargs = pytree.tree_unflatten(
+                    flat_args, tensor_args_spec
+                )
+                tree_out = fn(*tensor_args, **kwargs)
+                flat_out, spec = pytree.tree_flatten(tree_out)
+                out_spec.set(spec)
+                return flat_out
+
+            replay_fn = _record_cuda_graph(flat_fn, flat_tensor_args)
+            cached_res = (replay_fn, out_spec)
+            compile_cache.insert(
+                fn_id,
+                0,
+                0,
+                num_tensor_args,
+                hasher_type,
+                cached_res,
+                *flat_tensor_args,
+            )
+
+        replay_fn, out_spec = cached_res
+        out = replay_fn(*flat_tensor_args)
+        return out_spec.unflatten(out)
+
+    return returned_function
+
+
 def num_of_recompilations():
     """
     Returns the numbers of recompilations since the last time cache was cleared.
@@ -475,6 +827,61 @@ def clear_compile_cache():
         compile_cache = None
 
 
+def set_compile_cache_max_size(max_size):
+    """
+    Bounds the compilation cache to at most :attr:`max_size` entries (pass 0
+    to make it unbounded again, the default). When the bound is hit, entries
+    that have not been used recently are evicted instead of the whole cache
+    being dropped, avoiding the recompilation storm of
+    :func:`clear_compile_cache`.
+    """
+    global compile_cache
+    if compile_cache is None:
+        compile_cache = CompileCache()
+    compile_cache.set_max_size(max_size)
+
+
+def compile_cache_evictions():
+    """
+    Returns the number of cache entries evicted since the cache was created.
+    See :func:`set_compile_cache_max_size`.
+    """
+    global compile_cache
+    if compile_cache is None:
+        return 0
+    return compile_cache.num_evictions()
+
+
+def save_compile_cache(path):
+    """
+    Persists the compilation cache to disk so a later process can warm-start
+    from it (see :func:`load_compile_cache`). Entries whose compiled
+    artifacts cannot be pickled are skipped and will simply recompile.
+    Cache keys identify functions and compilers by qualified name and source
+    text (see NOTE: [Stable cache ids]), so entries hit across processes as
+    long as those sources are unchanged; callables without retrievable
+    source fall back to per-process ids and will not warm-start.
+    Returns the number of entries written.
+    """
+    global compile_cache
+    if compile_cache is None:
+        return 0
+    return compile_cache.save(path)
+
+
+def load_compile_cache(path):
+    """
+    Loads a cache previously written by :func:`save_compile_cache`. Keys are
+    registered eagerly but artifacts are only deserialized on their first
+    hit. Files written by a different torch build are ignored. Returns the
+    number of entries made available.
+    """
+    global compile_cache
+    if compile_cache is None:
+        compile_cache = CompileCache()
+    return compile_cache.load(path)
+
+
 def aot_module(mod, *args, **kwargs):
     def functional_call(named_params, named_buffers, *args, **kwargs):
         params_and_buffers = {**named_params, **named_buffers}
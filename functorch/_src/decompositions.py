@@ -504,3 +504,27 @@ def detach_decomposition(x):
 # @register_decomposition(aten.cudnn_batch_norm_backward)
 # def cudnn_batch_norm_backward(input: Tensor, grad_output: Tensor, weight: Tensor, running_mean: Optional[Tensor], running_var: Optional[Tensor], save_mean: Optional[Tensor], save_var: Optional[Tensor], epsilon: float, reserveSpace: Tensor):
 #     return aten.native_batch_norm_backward(grad_output, input, weight, running_mean, running_var, save_mean, save_var, True, epsilon, [True, True, True])
+
+
+# NOTE: [Native decomposition registry]
+# Some decompositions live in C++ (see Decompositions.cpp) so that the vmap
+# fallback can use them without a round trip to Python. Mirror them into
+# decomposition_table here so the tracer consults the same table: under
+# __torch_dispatch__, _run_native_decomposition re-enters the dispatcher for
+# each primitive, so the traced graph records the decomposed ops.
+def _register_native_decompositions():
+    from functools import partial
+    from functorch._C import _decomposition_registry_ops, _run_native_decomposition
+    for qualname in _decomposition_registry_ops():
+        # The C++ registry is keyed per-overload ("aten::copysign.Tensor");
+        # this table is keyed by overload packet, and the native entry point
+        # re-resolves the overload from the arguments.
+        base = qualname.split(".", 1)[0]
+        packet = getattr(aten, base.split("::", 1)[1])
+        if packet in decomposition_table:
+            # A hand-written Python decomposition takes precedence.
+            continue
+        decomposition_table[packet] = partial(_run_native_decomposition, base)
+
+
+_register_native_decompositions()
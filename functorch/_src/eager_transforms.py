@@ -9,28 +9,45 @@ import torch
 from functools import partial, wraps
 import contextlib
 from torch.utils._pytree import tree_flatten, tree_unflatten, tree_map
-from .pytree_hacks import tree_map_, treespec_pprint
+from .pytree_hacks import treespec_pprint
 import torch.autograd.forward_ad as fwAD
 
 from .vmap import vmap
 
 from functorch._C import (
     _wrap_for_grad,
+    _wrap_for_grad_bulk,
     _unwrap_for_grad,
+    _unwrap_for_grad_bulk,
+    _set_tensors_requires_grad,
     _grad_increment_nesting,
+    _grad_increment_nesting_and_wrap,
     _grad_decrement_nesting,
+    _assemble_jacrev_blocks,
+    _assemble_jacfwd_blocks,
 )
 
 argnums_t = Union[int, Tuple[int, ...]]
 
 
+# NOTE: [Bulk grad bookkeeping]
+# grad/vjp used to cross the Python/C++ boundary once per tensor leaf for
+# wrapping, differentiability marking, and output unwrapping; for small
+# losses called at high rates the bookkeeping cost more than the backward.
+# The helpers here flatten once and do the per-tensor work in a single
+# native call (see NOTE: [Bulk grad wrapping] in init.cpp), leaving only
+# the pytree spec handling in Python.
+
+
 def _create_differentiable(inps, level=None):
-    def create_differentiable(x):
-        if isinstance(x, torch.Tensor):
-            return x.requires_grad_()
-        raise ValueError(f'Thing passed to transform API must be Tensor, '
-                         f'got {type(x)}')
-    return tree_map(create_differentiable, inps)
+    flat, _ = tree_flatten(inps)
+    for x in flat:
+        if not isinstance(x, torch.Tensor):
+            raise ValueError(f'Thing passed to transform API must be Tensor, '
+                             f'got {type(x)}')
+    # In-place on the wrappers, so the input tree can be returned as is.
+    _set_tensors_requires_grad(flat)
+    return inps
 
 
 def _undo_create_differentiable(inps, level=None):
@@ -64,7 +81,25 @@ def _wrap_tensor_for_grad(maybe_tensor, level):
 
 
 def _wrap_all_tensors(tensor_pytree, level):
-    return tree_map(partial(_wrap_tensor_for_grad, level=level), tensor_pytree)
+    flat, spec = tree_flatten(tensor_pytree)
+    tensor_idxs = [i for i, x in enumerate(flat) if isinstance(x, torch.Tensor)]
+    if tensor_idxs:
+        wrapped = _wrap_for_grad_bulk([flat[i] for i in tensor_idxs], level)
+        for i, tensor in zip(tensor_idxs, wrapped):
+            flat[i] = tensor
+    return tree_unflatten(flat, spec)
+
+
+def _wrap_all_tensors_and_increment_nesting(tensor_pytree):
+    # Fuses the level push with the wrapping so entering grad/vjp costs a
+    # single native call regardless of how many tensors are passed in.
+    flat, spec = tree_flatten(tensor_pytree)
+    tensor_idxs = [i for i, x in enumerate(flat) if isinstance(x, torch.Tensor)]
+    level, wrapped = _grad_increment_nesting_and_wrap(
+        [flat[i] for i in tensor_idxs])
+    for i, tensor in zip(tensor_idxs, wrapped):
+        flat[i] = tensor
+    return level, tree_unflatten(flat, spec)
 
 
 def _as_tuple(val):
@@ -234,11 +269,10 @@ def vjp(func: Callable, *primals, has_aux: bool = False):
         outer one. This is because ``vjp`` is a "function transform": its result
         should not depend on the result of a context manager outside of ``f``.
     """
-    level = _grad_increment_nesting()
+    level, primals = _wrap_all_tensors_and_increment_nesting(primals)
     try:
         # See NOTE [grad and vjp interaction with no_grad]
         with torch.enable_grad():
-            primals = _wrap_all_tensors(primals, level)
             diff_primals = _create_differentiable(primals, level)
             primals_out = func(*diff_primals)
 
@@ -431,25 +465,19 @@ def jacrev(func: Callable, argnums: Union[int, Tuple[int]] = 0, *, has_aux=False
         flat_primals, primals_spec = tree_flatten(primals)
         flat_results, results_spec = tree_flatten(results)
 
-        # Step 2: The returned jacobian is one big tensor per input. In this step,
-        # we split each Tensor by output.
-        flat_results = [result.split(flat_output_numels, dim=0) for result in flat_results]
-        flat_input_flat_output = [
-            tuple(split.view(out.shape + primal.shape)
-                  for split, out in zip(splits, flat_output))
-            for splits, primal in zip(flat_results, flat_primals)
-        ]
-
-        # Step 3: Right now, `jacobian` is a List[List[Tensor]].
-        # The outer List corresponds to the number of primals,
-        # the inner List corresponds to the number of outputs.
-        # We need to:
-        # a. Exchange the order of the outer List and inner List
-        # b. tree_unflatten the inner Lists (which correspond to the primals)
-        # c. handle the argnums=int case
-        # d. tree_unflatten the outer List (which corresponds to the outputs)
-        flat_output_flat_input = tuple(zip(*flat_input_flat_output))
-
+        # Step 2: The returned jacobian is one big tensor per input. Carve
+        # each one into the final per-(output, input) views in a single
+        # native call; see NOTE: [Native jacobian assembly] in init.cpp.
+        # The result is outputs-major: List[List[Tensor]] where the outer
+        # List corresponds to the outputs and the inner to the primals.
+        flat_output_flat_input = _assemble_jacrev_blocks(
+            flat_results, flat_output_numels,
+            [out.shape for out in flat_output])
+
+        # Step 3: We need to:
+        # a. tree_unflatten the inner Lists (which correspond to the primals)
+        # b. handle the argnums=int case
+        # c. tree_unflatten the outer List (which corresponds to the outputs)
         flat_output_input = tuple(tree_unflatten(flat_input, primals_spec)
                                   for flat_input in flat_output_flat_input)
 
@@ -937,14 +965,11 @@ def jacfwd(func: Callable, argnums: argnums_t = 0, has_aux: bool = False):
         # as jvp should test the output before
         # assert_non_empty_output(jac_outs, 'jacfwd(f, ...)(*args)')
 
-        jac_outs_ins = tuple(
-            tuple(
-                safe_unflatten(jac_out_in, -1, primal.shape)
-                for primal, jac_out_in in
-                zip(flat_primals, jac_out.movedim(0, -1).split(flat_primals_numels, dim=-1))
-            )
-            for jac_out in jac_outs
-        )
+        # One native call carves every per-(output, primal) block out as a
+        # view; see NOTE: [Native jacobian assembly] in init.cpp.
+        jac_outs_ins = _assemble_jacfwd_blocks(
+            jac_outs, flat_primals_numels,
+            [p.shape for p in flat_primals])
         jac_outs_ins = tuple(tree_unflatten(jac_ins, primals_spec) for jac_ins in jac_outs_ins)
 
         if isinstance(argnums, int):
@@ -1027,15 +1052,13 @@ def grad_and_value(func: Callable, argnums: argnums_t = 0, has_aux: bool = False
     """
     @wraps(func)
     def wrapper(*args, **kwargs):
-        level = _grad_increment_nesting()
+        level, (args, kwargs) = _wrap_all_tensors_and_increment_nesting((args, kwargs))
         try:
             output, aux, grad_input = None, None, None
             # See NOTE [grad and vjp interaction with no_grad]
             with torch.enable_grad():
-                args = _wrap_all_tensors(args, level)
-                kwargs = _wrap_all_tensors(kwargs, level)
                 diff_args = _slice_argnums(args, argnums, as_tuple=False)
-                tree_map_(partial(_create_differentiable, level=level), diff_args)
+                _create_differentiable(diff_args, level)
 
                 output = func(*args, **kwargs)
                 if has_aux:
@@ -1060,9 +1083,11 @@ def grad_and_value(func: Callable, argnums: argnums_t = 0, has_aux: bool = False
                 # NB: need create_graph so that backward pass isn't run in no_grad mode
                 flat_outputs = _as_tuple(output)
                 flat_grad_input = _autograd_grad(flat_outputs, flat_diff_args, create_graph=True)
+                # _autograd_grad never returns None entries, so the flat list
+                # can be unwrapped in one native call before unflattening.
+                flat_grad_input = _unwrap_for_grad_bulk(flat_grad_input, level)
                 grad_input = tree_unflatten(flat_grad_input, spec)
 
-                grad_input = _undo_create_differentiable(grad_input, level)
                 output = _undo_create_differentiable(output, level)
                 if aux is not None:
                     aux = _undo_create_differentiable(aux, level)
@@ -9,6 +9,7 @@ import torch.nn as nn
 from torch import Tensor
 from typing import List, Tuple
 from .named_members_polyfill import _named_parameters, _named_buffers
+from functorch._C import _swap_module_attrs
 import copy
 
 # Utilities to make nn.Module "functional"
@@ -104,6 +105,29 @@ def _swap_state(mod: nn.Module, split_names: List[str], elems):
     return result
 
 
+# NOTE: [Precomputed swap plan]
+# _swap_state walks the module tree and goes through nn.Module's
+# __setattr__/__delattr__ for every tensor on every stateless call -- about
+# 800 Python attribute writes per forward for a ResNet, repeated per vmap
+# lane setup. Instead, resolve each dotted name to its submodule __dict__
+# exactly once at construction time; FunctionalModule(WithBuffers).forward
+# then installs and restores all tensors in a single C++ call
+# (_swap_module_attrs). Instance __dict__ entries shadow the
+# _parameters/_buffers fallbacks in nn.Module.__getattr__, so reads inside
+# the wrapped forward see the installed tensors.
+def _make_swap_plan(mod: nn.Module, names: List[str]):
+    dicts = []
+    attrs = []
+    for name in names:
+        path = name.split(".")
+        submodule = mod
+        for part in path[:-1]:
+            submodule = getattr(submodule, part)
+        dicts.append(submodule.__dict__)
+        attrs.append(path[-1])
+    return dicts, attrs
+
+
 def extract_buffers(mod: nn.Module) -> Tuple[Tuple[Tensor, ...], List[str]]:
     num_orig_params_with_duplicates = len(tuple(_named_buffers(mod, remove_duplicate=False)))
     orig_params = tuple(mod.buffers())
@@ -236,6 +260,8 @@ class FunctionalModuleWithBuffers(nn.Module):
         self.param_names = param_names
         self.buffer_names = buffer_names
         self.split_names = make_split_names(param_names + buffer_names)
+        # See NOTE: [Precomputed swap plan]
+        self._swap_plan = _make_swap_plan(stateless_model, param_names + buffer_names)
 
     @staticmethod
     def _create_from(model):
@@ -250,16 +276,15 @@ class FunctionalModuleWithBuffers(nn.Module):
         )
 
     def forward(self, params, buffers, *args, **kwargs):
-        # Temporarily load the state back onto self.stateless_model
-        old_state = _swap_state(
-            self.stateless_model,
-            self.split_names,
-            list(params) + list(buffers))
+        # Temporarily load the state back onto self.stateless_model.
+        # See NOTE: [Precomputed swap plan]
+        dicts, attrs = self._swap_plan
+        old_state = _swap_module_attrs(dicts, attrs, list(params) + list(buffers))
         try:
             return self.stateless_model(*args, **kwargs)
         finally:
             # Remove the loaded state on self.stateless_model
-            _swap_state(self.stateless_model, self.split_names, old_state)
+            _swap_module_attrs(dicts, attrs, old_state)
 
 
 class FunctionalModule(nn.Module):
@@ -272,6 +297,8 @@ class FunctionalModule(nn.Module):
         self.stateless_model = stateless_model
         self.param_names = param_names
         self.split_names = make_split_names(param_names)
+        # See NOTE: [Precomputed swap plan]
+        self._swap_plan = _make_swap_plan(stateless_model, param_names)
 
     @staticmethod
     def _create_from(model):
@@ -281,13 +308,15 @@ class FunctionalModule(nn.Module):
         return FunctionalModule(model_copy, param_names), params
 
     def forward(self, params, *args, **kwargs):
-        # Temporarily load the state back onto self.stateless_model
-        old_state = _swap_state(self.stateless_model, self.split_names, params)
+        # Temporarily load the state back onto self.stateless_model.
+        # See NOTE: [Precomputed swap plan]
+        dicts, attrs = self._swap_plan
+        old_state = _swap_module_attrs(dicts, attrs, list(params))
         try:
             return self.stateless_model(*args, **kwargs)
         finally:
             # Remove the loaded state on self.stateless_model
-            _swap_state(self.stateless_model, self.split_names, old_state)
+            _swap_module_attrs(dicts, attrs, old_state)
 
 
 def make_functional(model: nn.Module):
@@ -394,8 +394,23 @@ class PointwiseCompiler(object):
             assert inner
             flattened.set_gpu_block_index(0)
             inner.set_gpu_thread_index(0)
-        elif self.dtype == "llvm" and loops:
-            pass  # TODO(jansel): need a parallel CPU schedule
+        elif self.compile_mode == "llvm" and loops:
+            d = self.output_order[0]
+            widths = [
+                s.vector_width
+                for s, shape in zip(self.spec, self.shape_flags)
+                if shape[d] == "other"
+            ]
+            # The key's vector_width describes the trailing dim, so only
+            # vectorize when that is the innermost loop; divisible extents
+            # split without a scalar tail.
+            if d == self.ndim - 1 and widths and min(widths) > 1:
+                try:
+                    inner = _te.LoopNest.split_with_mask(loops[-1], min(widths))
+                    assert inner
+                    _te.LoopNest.vectorize(inner)
+                except RuntimeError:
+                    pass  # e.g. strided loads the vectorizer rejects
 
         loopnest.prepare_for_codegen()
         cg = _te.construct_codegen(
@@ -414,6 +429,122 @@ class PointwiseCompiler(object):
         self.compute_code()
 
 
+class ReductionCompiler(PointwiseCompiler):
+    """
+    Compiles a pointwise prologue followed by a sum/mean/max reduction over
+    the trailing dims, with an optional pointwise epilogue fused onto the
+    reduced value. Reuses all the pointwise machinery for broadcasting,
+    stride specialization, and input indexing; only the loop structure and
+    output allocation differ (the output drops the reduced dims).
+    """
+
+    def __init__(
+        self,
+        name: str,
+        module_name: str,
+        pointwise_fn: Callable,
+        spec: List,
+        result: PointwiseOperatorCompileResult,
+        reduction: str,
+        num_reduce_dims: int,
+        epilogue_fn: Optional[Callable],
+    ):
+        self.reduction = reduction
+        self.num_reduce_dims = num_reduce_dims
+        self.epilogue_fn = epilogue_fn
+        super().__init__(name, module_name, pointwise_fn, spec, result)
+
+    def error_checks(self):
+        super().error_checks()
+        assert self.device == "cpu", "TODO: support reductions on cuda"
+        assert not self.spec[-1].out, "TODO: support out= for reductions"
+        assert 0 < self.num_reduce_dims <= self.ndim
+        if self.reduction == "max":
+            assert self.dtype.is_floating_point, "max reduction requires floats"
+
+    def handle_autograd(self):
+        if any(x.requires_grad for x in self.spec):
+            raise NotImplementedError("TODO: support autograd for reductions")
+
+    def compute_output_order(self):
+        # The reduced dims must stay the innermost loops; the kept dims are
+        # iterated in index order with the output allocated contiguous.
+        assert not self.output_order
+        self.output_order = list(range(self.ndim))
+
+    def compute_code(self):
+        num_kept = self.ndim - self.num_reduce_dims
+        bufs = [_te.BufHandle(s.dtype) for s in self.spec]
+        options_from = [
+            i for i in range(len(self.spec)) if self.spec[i].dtype == self.dtype
+        ][0]
+        # A storage order covering only the kept dims tells the C++ side to
+        # allocate an output of lower rank than the iteration space.
+        self.result.add_allocated_output(
+            options_from, list(reversed(range(num_kept)))
+        )
+        out_buf = _te.BufHandle(self.dtype)
+        bufs_args = bufs + [out_buf]
+
+        inputs = [
+            _te.Cast.make(self.dtype, buf.load(self.indexing(stride)))
+            for buf, stride in zip(bufs, self.strides)
+        ]
+        val = _fx_to_expr(self.pointwise_fn, self.dtype)(*inputs)
+
+        # Contiguous indexing over the kept dims only.
+        out_idx = _zero()
+        next_stride = _one()
+        for d in reversed(range(num_kept)):
+            out_idx = out_idx + self.iter_vars[d] * next_stride
+            next_stride = next_stride * self.shape_vars[d]
+
+        if self.reduction == "max":
+            init = _create_constant(float("-inf"), self.dtype)
+            acc = _te.Cast.make(self.dtype, out_buf.load(out_idx))
+            combined = _te.ifThenElse(acc > val, acc, val)
+        else:
+            init = _create_constant(0.0, self.dtype)
+            acc = _te.Cast.make(self.dtype, out_buf.load(out_idx))
+            combined = acc + val
+
+        body = out_buf.store(out_idx, combined)
+        for d in reversed(range(num_kept, self.ndim)):
+            body = _te.For.make(
+                self.iter_vars[d], _zero(), self.shape_vars[d], body
+            )
+
+        stmts = [out_buf.store(out_idx, init), body]
+
+        final = None
+        if self.reduction == "mean":
+            count = _one()
+            for d in range(num_kept, self.ndim):
+                count = count * self.shape_vars[d]
+            final = _te.Cast.make(self.dtype, out_buf.load(out_idx)) / _te.Cast.make(
+                self.dtype, count
+            )
+        if self.epilogue_fn is not None:
+            if final is None:
+                final = _te.Cast.make(self.dtype, out_buf.load(out_idx))
+            final = _fx_to_expr(self.epilogue_fn, self.dtype)(final)
+        if final is not None:
+            stmts.append(out_buf.store(out_idx, final))
+
+        out = _te.Block(stmts)
+        for d in reversed(range(num_kept)):
+            out = _te.For.make(self.iter_vars[d], _zero(), self.shape_vars[d], out)
+
+        loopnest = _te.LoopNest(_te.Block([out]), [out_buf])
+        loopnest.prepare_for_codegen()
+        cg = _te.construct_codegen(
+            self.compile_mode,
+            loopnest.simplify(),
+            bufs_args + self.stride_args + self.shape_args,
+        )
+        self.result.set_code(cg)
+
+
 class _PointwiseOperatorCompileCache(PointwiseOperatorCompileCache):
     pass
 
@@ -453,3 +584,61 @@ def pointwise_operator(
     rv.__qualname__ = name
     rv.__module__ = module_name
     return rv
+
+
+def reduction_operator(
+    fn: Optional[Callable] = None,
+    *,
+    reduction: str = "sum",
+    num_reduce_dims: int = 1,
+    epilogue: Optional[Callable] = None,
+    name: Optional[str] = None,
+    module_name: Optional[str] = None,
+):
+    """
+    Decorator to create an operator that applies a pointwise function to its
+    inputs and reduces the result over the trailing :attr:`num_reduce_dims`
+    dimensions, optionally applying a pointwise :attr:`epilogue` to the
+    reduced value. Everything runs in one fused JIT-compiled kernel, like
+    :func:`pointwise_operator`.
+
+        @reduction_operator(reduction="sum", num_reduce_dims=1)
+        def dot(a, b):
+            return a * b
+
+    Supported reductions: "sum", "mean", "max". CPU only for now.
+    """
+    if fn is None:
+        return functools.partial(
+            reduction_operator,
+            reduction=reduction,
+            num_reduce_dims=num_reduce_dims,
+            epilogue=epilogue,
+            name=name,
+            module_name=module_name,
+        )
+    assert reduction in ("sum", "mean", "max"), reduction
+    name = name or fn.__name__
+    module_name = module_name or fn.__module__
+    args = [f"Tensor {name}" for name in inspect.signature(fn).parameters.keys()]
+    signature = f"{name}({', '.join(args)}, *, Tensor? out=None)"
+
+    def compile_fn(spec, result):
+        return ReductionCompiler(
+            str(name),
+            str(module_name),
+            fn,
+            spec,
+            result,
+            reduction,
+            num_reduce_dims,
+            epilogue,
+        )
+
+    rv = _PointwiseOperatorCompileCache(
+        name, module_name, [signature], compile_fn, _num_args(fn)
+    )
+    rv.__name__ = name
+    rv.__qualname__ = name
+    rv.__module__ = module_name
+    return rv
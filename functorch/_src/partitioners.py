@@ -153,6 +153,19 @@ def _size_of(metadata):
     return numel * sizes[dtype]
 
 
+# NOTE: [Partition decision cache]
+# Maps a joint graph's topology key -- per node: op, target, bans,
+# tangent-closure membership, and user edges, but *not* tensor sizes -- to
+# the indices of the nodes the min cut chose to save. Different shape
+# specializations of the same program trace to the same topology, so they
+# reuse the partition instead of re-running max-flow per CompileCache miss.
+_partition_decision_cache = {}
+
+
+def clear_partition_decision_cache():
+    _partition_decision_cache.clear()
+
+
 def min_cut_rematerialization_partition(joint_module: fx.GraphModule, _joint_inputs):
     """
     Partitions the joint graph such that the backward recomputes the forward.
@@ -162,18 +175,13 @@ def min_cut_rematerialization_partition(joint_module: fx.GraphModule, _joint_inp
     outputs to just original forward or backward outputs. And then we run the
     resulting graphs through dead code elimintation.
     """
-    try:
-        import networkx as nx
-    except ImportError:
-        raise RuntimeError("Need networkx installed to perform smart recomputation heuristics")
+    from functorch._C import _min_cut_reachable
 
     # draw_graph(joint_module, "joint.svg")
     full_bw_graph = joint_module.graph
 
     tangent_closure = set()
-    name_to_node = {}
     for node in full_bw_graph.nodes:
-        name_to_node[node.name] = node
         if node.op == 'placeholder' and "tangents" in node.target:
             tangent_closure.add(node)
         if node in tangent_closure:
@@ -231,44 +239,69 @@ def min_cut_rematerialization_partition(joint_module: fx.GraphModule, _joint_inp
         else:
             return mem_sz * 2
 
-    nx_graph = nx.DiGraph()
-    for node in full_bw_graph.nodes:
-        if node in tangent_closure and node.op != 'output':
-            nx_graph.add_edge(node.name+"_in", "sink", capacity=math.inf)
+    # See NOTE: [Native min-cut max-flow]. Each fx node becomes an in/out
+    # vertex pair (2i, 2i + 1) connected by an edge carrying the node's
+    # memory weight; everything else is an infinite edge that can never be
+    # cut. The flat edge lists go straight to the C++ solver instead of
+    # through a networkx DiGraph, which dominated compile time on large
+    # joint graphs.
+    node_list = list(full_bw_graph.nodes)
+    node_idx = {node: i for i, node in enumerate(node_list)}
+    source = 2 * len(node_list)
+    sink = source + 1
+
+    edge_src, edge_dst, edge_cap = [], [], []
+
+    def add_edge(u, v, capacity):
+        edge_src.append(u)
+        edge_dst.append(v)
+        edge_cap.append(capacity)
+
+    topology_key = []
+    for i, node in enumerate(node_list):
+        node_in, node_out = 2 * i, 2 * i + 1
+        in_closure = node in tangent_closure and node.op != 'output'
+        is_primal = node.op == 'placeholder' and "primals" in node.target
+        banned = ban_recomputation(node)
+        has_meta = 'tensor_meta' in node.meta
+        users_idx = tuple(node_idx[user] for user in node.users)
+        # Everything that shapes the flow network except the finite weight
+        # magnitudes; see NOTE: [Partition decision cache].
+        topology_key.append(
+            (node.op, str(node.target), in_closure, is_primal, banned,
+             has_meta, users_idx))
+
+        if in_closure:
+            add_edge(node_in, sink, math.inf)
             continue
 
-        if node.op == 'placeholder' and "primals" in node.target:
-            nx_graph.add_edge("source", node.name+"_in", capacity=math.inf)
-
         # If a node can't be recomputed (too expensive or involves randomness),
         # we prevent it from being recomputed by adding an inf edge to the source
-        if ban_recomputation(node):
-            nx_graph.add_edge("source", node.name+"_in", capacity=math.inf)
+        if is_primal or banned:
+            add_edge(source, node_in, math.inf)
 
-        if 'tensor_meta' not in node.meta:
-            weight = math.inf
-        else:
-            weight = get_node_weight(node)
+        weight = get_node_weight(node) if has_meta else math.inf
 
         # Creates the weights on the "node" edge
-        nx_graph.add_edge(node.name+"_in", node.name+"_out", capacity=weight)
+        add_edge(node_in, node_out, weight)
         for user in node.users:
-            nx_graph.add_edge(node.name+"_out", user.name+"_in", capacity=math.inf)
-
-    cut_value, partition = nx.minimum_cut(nx_graph, "source", "sink")
-    reachable, non_reachable = partition
-    cutset = set()
-    for u, nbrs in ((n, nx_graph[n]) for n in reachable):
-        cutset.update((u, v) for v in nbrs if v in non_reachable)
-
-    cut_nodes = set()
-    for node_in, node_out in cutset:
-        assert node_in[:-3] == node_out[:-4]
-        node_name = node_in[:-3]
-        cut_nodes.add(node_name)
-    # print(len(cut_nodes), sorted(list(cut_nodes)))
-
-    saved_values = [name_to_node[node] for node in cut_nodes]
+            add_edge(node_out, 2 * node_idx[user], math.inf)
+
+    cache_key = tuple(topology_key)
+    cut_indices = _partition_decision_cache.get(cache_key)
+    if cut_indices is None:
+        reachable = set(_min_cut_reachable(
+            sink + 1, edge_src, edge_dst, edge_cap, source, sink))
+        # The only finite edges are the in->out node edges, so the cut
+        # consists exactly of the nodes whose in vertex is on the source
+        # side and whose out vertex is not.
+        cut_indices = tuple(
+            i for i in range(len(node_list))
+            if 2 * i in reachable and 2 * i + 1 not in reachable)
+        _partition_decision_cache[cache_key] = cut_indices
+    # print(len(cut_indices), sorted(node_list[i].name for i in cut_indices))
+
+    saved_values = [node_list[i] for i in cut_indices]
 
     return _extract_fwd_bwd_modules(joint_module, saved_values)
 
@@ -9,14 +9,17 @@ import functools
 from collections import OrderedDict
 from torch import Tensor
 from typing import Any, Callable, Optional, Tuple, Union, List
-from torch.utils._pytree import tree_flatten, tree_unflatten, _broadcast_to_and_flatten, TreeSpec, _register_pytree_node
+from torch.utils._pytree import tree_flatten, tree_unflatten, tree_map, _broadcast_to_and_flatten, TreeSpec, _register_pytree_node
 from .pytree_hacks import tree_map_
 from functools import partial
 import inspect
 
 from functorch._C import (
     _add_batch_dim,
+    _add_batch_dims,
     _remove_batch_dim,
+    _remove_batch_dims,
+    _validate_and_get_batch_size as _c_validate_and_get_batch_size,
     _vmap_decrement_nesting,
     _vmap_increment_nesting,
 )
@@ -59,13 +62,12 @@ _register_pytree_node(OrderedDict, _odict_flatten, _odict_unflatten)
 def _validate_and_get_batch_size(
         flat_in_dims: List[Optional[int]],
         flat_args: List) -> int:
-    batch_sizes = [arg.size(in_dim) for in_dim, arg in zip(flat_in_dims, flat_args)
-                   if in_dim is not None]
-    if batch_sizes and any([size != batch_sizes[0] for size in batch_sizes]):
-        raise ValueError(
-            f'vmap: Expected all tensors to have the same size in the mapped '
-            f'dimension, got sizes {batch_sizes} for the mapped dimension')
-    return batch_sizes[0]
+    # Non-tensor args always have in_dim None (checked by
+    # _process_batched_inputs), so only tensors reach the C++ validation.
+    batched = [(arg, in_dim) for in_dim, arg in zip(flat_in_dims, flat_args)
+               if in_dim is not None]
+    return _c_validate_and_get_batch_size(
+        [arg for arg, _ in batched], [in_dim for _, in_dim in batched])
 
 
 def _num_outputs(batched_outputs: Union[Tensor, Tuple[Tensor, ...]]) -> int:
@@ -138,9 +140,17 @@ def _process_batched_inputs(
 def _create_batched_inputs(
         flat_in_dims: List[Any], flat_args: List[Any], vmap_level: int, args_spec) -> Tuple:
     # See NOTE [Ignored _remove_batch_dim, _add_batch_dim]
-    batched_inputs = [arg if in_dim is None else
-                      _add_batch_dim(arg, in_dim, vmap_level)  # type: ignore
-                      for in_dim, arg in zip(flat_in_dims, flat_args)]
+    # All tensor leaves get wrapped in one C++ call instead of one
+    # _add_batch_dim call per leaf; non-tensor leaves (in_dim None) pass
+    # through untouched.
+    batched_idxs = [i for i, in_dim in enumerate(flat_in_dims) if in_dim is not None]
+    wrapped = _add_batch_dims(
+        [flat_args[i] for i in batched_idxs],
+        [flat_in_dims[i] for i in batched_idxs],
+        vmap_level)
+    batched_inputs = list(flat_args)
+    for i, tensor in zip(batched_idxs, wrapped):
+        batched_inputs[i] = tensor
     return tree_unflatten(batched_inputs, args_spec)
 
 # Undos the batching (and any batch dimensions) associated with the `vmap_level`.
@@ -180,10 +190,9 @@ def _unwrap_batched(
         if flat_out_dims is None:
             incompatible_error()
 
-    flat_outputs = [
-        _remove_batch_dim(batched_output, vmap_level, batch_size, out_dim)
-        for batched_output, out_dim in zip(flat_batched_outputs, flat_out_dims)
-    ]
+    # One C++ call for the whole flat output list.
+    flat_outputs = _remove_batch_dims(
+        flat_batched_outputs, vmap_level, batch_size, list(flat_out_dims))
     return tree_unflatten(flat_outputs, output_spec)
 
 
@@ -202,6 +211,108 @@ def _check_out_dims_is_int_or_int_pytree(out_dims: out_dims_t, func: Callable) -
     tree_map_(partial(_check_int, func=func, out_dims=out_dims), out_dims)
 
 
+# Splits the batched args into per-chunk views along their in_dims. Unbatched
+# args (in_dim None) are shared across chunks. Returns a list of
+# (chunk_flat_args, chunk_batch_size) pairs.
+def _split_into_chunks(
+        flat_args: List[Any], flat_in_dims: List[Optional[int]],
+        batch_size: int, chunk_size: int) -> List[Tuple[List[Any], int]]:
+    chunks = []
+    for start in range(0, batch_size, chunk_size):
+        length = min(chunk_size, batch_size - start)
+        chunk_flat_args = [
+            arg if in_dim is None else arg.narrow(in_dim, start, length)
+            for in_dim, arg in zip(flat_in_dims, flat_args)
+        ]
+        chunks.append((chunk_flat_args, length))
+    return chunks
+
+
+# Concatenates the per-chunk outputs along their out_dims to reassemble the
+# full batch. torch.cat does the stitching in one native call per output.
+def _stitch_chunked_outputs(chunk_outputs: List[Any], out_dims: out_dims_t, func: Callable):
+    flat_first_output, output_spec = tree_flatten(chunk_outputs[0])
+    flat_out_dims = _broadcast_to_and_flatten(out_dims, output_spec)
+    if flat_out_dims is None:
+        raise ValueError(
+            f'vmap({_get_name(func)}, ..., out_dims={out_dims})(<inputs>): '
+            f'out_dims is not compatible with the structure of `outputs`. '
+            f'out_dims has structure {tree_flatten(out_dims)[1]} but outputs '
+            f'has structure {output_spec}.')
+    flat_chunks = [flat_first_output] + [tree_flatten(output)[0] for output in chunk_outputs[1:]]
+    flat_outputs = [
+        torch.cat([chunk[i] for chunk in flat_chunks], dim=out_dim)
+        for i, out_dim in enumerate(flat_out_dims)
+    ]
+    return tree_unflatten(flat_outputs, output_spec)
+
+
+def _chunked_vmap(func, flat_in_dims, flat_args, args_spec, out_dims,
+                  randomness, batch_size, chunk_size, **kwargs):
+    chunk_outputs = [
+        _flat_vmap(func, chunk_batch_size, flat_in_dims, chunk_flat_args,
+                   args_spec, out_dims, randomness, **kwargs)
+        for chunk_flat_args, chunk_batch_size
+        in _split_into_chunks(flat_args, flat_in_dims, batch_size, chunk_size)
+    ]
+    return _stitch_chunked_outputs(chunk_outputs, out_dims, func)
+
+
+# NOTE: [Device-sharded vmap]
+# With `devices`, the batch dim is split into one shard per device, each
+# shard's transformed call is issued on its own CUDA stream, and the shard
+# outputs are gathered back to the inputs' device and stitched with the same
+# machinery _chunked_vmap uses. The host loop only launches work -- kernel
+# launches and the copy-in/copy-out are asynchronous on the shard streams --
+# so compute on one GPU overlaps the transfers and compute of the others
+# without any threads (or the GIL) in the loop. Each shard is an ordinary
+# _flat_vmap, so BatchedTensorImpl and the batch rules are reused unchanged.
+def _device_sharded_vmap(func, flat_in_dims, flat_args, args_spec, out_dims,
+                         randomness, batch_size, devices, **kwargs):
+    num_shards = len(devices)
+    if batch_size < num_shards:
+        raise ValueError(
+            f'vmap({_get_name(func)}, ..., devices={devices})(<inputs>): '
+            f'batch size {batch_size} is smaller than the number of devices')
+    gather_device = None
+    for in_dim, arg in zip(flat_in_dims, flat_args):
+        if in_dim is not None:
+            gather_device = arg.device
+            break
+    shard_size = (batch_size + num_shards - 1) // num_shards
+    shards = _split_into_chunks(flat_args, flat_in_dims, batch_size, shard_size)
+
+    def to_device(device):
+        def go(x):
+            if isinstance(x, Tensor):
+                return x.to(device, non_blocking=True)
+            return x
+        return go
+
+    src_stream = torch.cuda.current_stream(gather_device) \
+        if gather_device is not None and gather_device.type == 'cuda' else None
+    streams = [torch.cuda.Stream(device=device) for device in devices]
+    shard_outputs = []
+    for (shard_flat_args, shard_batch_size), device, stream in zip(shards, devices, streams):
+        if src_stream is not None:
+            stream.wait_stream(src_stream)
+        with torch.cuda.device(device), torch.cuda.stream(stream):
+            moved_args = [to_device(device)(arg) for arg in shard_flat_args]
+            output = _flat_vmap(func, shard_batch_size, flat_in_dims, moved_args,
+                                args_spec, out_dims, randomness, **kwargs)
+            # Queue the gather on the shard's own stream so it overlaps the
+            # later shards' compute.
+            shard_outputs.append(tree_map(to_device(gather_device), output))
+    # The stitch below runs on the gather device's current stream; order it
+    # after every shard's copy-out.
+    for stream in streams:
+        if src_stream is not None:
+            src_stream.wait_stream(stream)
+        else:
+            stream.synchronize()
+    return _stitch_chunked_outputs(shard_outputs, out_dims, func)
+
+
 def _get_name(func: Callable):
     if hasattr(func, '__name__'):
         return func.__name__
@@ -223,7 +334,9 @@ def vmap(
         func: Callable,
         in_dims: in_dims_t = 0,
         out_dims: out_dims_t = 0,
-        randomness: str = 'error') -> Callable:
+        randomness: str = 'error',
+        chunk_size: Optional[int] = None,
+        devices: Optional[List] = None) -> Callable:
     """
     vmap is the vectorizing map; ``vmap(func)`` returns a new function that
     maps :attr:`func` over some dimension of the inputs. Semantically, vmap
@@ -251,6 +364,23 @@ def vmap(
             the randomness for each batch will be different. If 'same', the
             randomness will be the same across batches. If 'error', any calls to
             random functions will error. Default: 'error'.
+        chunk_size (None or int): If None (default), apply a single vmap over
+            the whole batch. Otherwise, map at most :attr:`chunk_size` examples
+            at a time and concatenate the per-chunk outputs, which bounds the
+            peak memory of the batch-expanded intermediates at the cost of
+            running the vmap pipeline once per chunk. Cannot be combined with
+            ``randomness='same'``: each chunk advances the global RNG, so
+            batches in different chunks would draw different random numbers.
+        devices (None or list): If given, a list of CUDA devices to shard the
+            batch dimension across. Each device runs its shard of the batch on
+            its own stream, overlapping compute with the inter-device
+            transfers; outputs are gathered back to the inputs' device. kwargs
+            are passed to every shard as-is. Cannot be combined with
+            ``randomness='same'``: shards draw from per-device generators
+            whose states are unrelated. With ``randomness='different'``,
+            draws depend on which device a batch lands on, so results change
+            with the device list and shard boundaries. See
+            NOTE: [Device-sharded vmap].
 
     Returns:
         Returns a new "batched" function. It takes the same inputs as
@@ -370,16 +500,47 @@ def vmap(
     """
     if randomness not in ['error', 'different', 'same']:
         raise RuntimeError(f"Only allowed values for randomness are 'error', 'different', or 'same'. Got {randomness}")
+    if chunk_size is not None and chunk_size < 1:
+        raise ValueError(f'vmap: chunk_size must be None or a positive integer, got {chunk_size}')
+    if chunk_size is not None and randomness == 'same':
+        # Each chunk re-enters the transformed function and advances the
+        # global RNG, so lanes in different chunks would draw different
+        # numbers, silently breaking the 'same' guarantee.
+        raise ValueError("vmap: chunk_size cannot be combined with randomness='same'")
+    if devices is not None:
+        if chunk_size is not None:
+            raise ValueError('vmap: chunk_size and devices cannot be combined')
+        if randomness == 'same':
+            # Shards run under per-device generators with unrelated states,
+            # so draws can never match across shards.
+            raise ValueError("vmap: devices cannot be combined with randomness='same'")
+        if len(devices) == 0:
+            raise ValueError('vmap: devices must be a non-empty list of CUDA devices')
+        devices = [torch.device(device) for device in devices]
+        for device in devices:
+            if device.type != 'cuda':
+                raise ValueError(f'vmap: devices must be CUDA devices, got {device}')
 
     @functools.wraps(func)
     def wrapped(*args, **kwargs):
         _check_out_dims_is_int_or_int_pytree(out_dims, func)
         batch_size, flat_in_dims, flat_args, args_spec = _process_batched_inputs(in_dims, args, func)
-        vmap_level = _vmap_increment_nesting(batch_size, randomness)
-        try:
-            batched_inputs = _create_batched_inputs(flat_in_dims, flat_args, vmap_level, args_spec)
-            batched_outputs = func(*batched_inputs, **kwargs)
-            return _unwrap_batched(batched_outputs, out_dims, vmap_level, batch_size, func)
-        finally:
-            _vmap_decrement_nesting()
+        if devices is not None:
+            return _device_sharded_vmap(func, flat_in_dims, flat_args, args_spec, out_dims,
+                                        randomness, batch_size, devices, **kwargs)
+        if chunk_size is not None and chunk_size < batch_size:
+            return _chunked_vmap(func, flat_in_dims, flat_args, args_spec, out_dims,
+                                 randomness, batch_size, chunk_size, **kwargs)
+        return _flat_vmap(func, batch_size, flat_in_dims, flat_args, args_spec,
+                          out_dims, randomness, **kwargs)
     return wrapped
+
+
+def _flat_vmap(func, batch_size, flat_in_dims, flat_args, args_spec, out_dims, randomness, **kwargs):
+    vmap_level = _vmap_increment_nesting(batch_size, randomness)
+    try:
+        batched_inputs = _create_batched_inputs(flat_in_dims, flat_args, vmap_level, args_spec)
+        batched_outputs = func(*batched_inputs, **kwargs)
+        return _unwrap_batched(batched_outputs, out_dims, vmap_level, batch_size, func)
+    finally:
+        _vmap_decrement_nesting()
@@ -1,4 +1,4 @@
-from .._src.operator_authoring import pointwise_operator
+from .._src.operator_authoring import pointwise_operator, reduction_operator
 from .._src.python_key import pythonkey_decompose
 from .._src.decompositions import register_decomposition, decomposition_table
 from .._src.fx_minifier import minifier, check_nvfuser_subprocess
@@ -7,8 +7,14 @@ from .._src.aot_autograd import (
     aot_module,
     compiled_function,
     compiled_module,
+    compiled_vmap,
+    cudagraphify,
     num_of_recompilations,
     clear_compile_cache,
+    save_compile_cache,
+    load_compile_cache,
+    set_compile_cache_max_size,
+    compile_cache_evictions,
 )
 from .._src.compilers import (
     ts_compile,
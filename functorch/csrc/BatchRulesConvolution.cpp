@@ -7,9 +7,89 @@
 #include <functorch/csrc/BatchRulesHelper.h>
 #include <functorch/csrc/PlumbingHelper.h>
 #include <ATen/core/dispatch/Dispatcher.h>
+#include <mutex>
+#include <unordered_map>
 
 namespace at { namespace functorch {
 
+// NOTE: [Conv plan reuse for batched weights]
+// Model ensembles hit the convolution batch rule with the same batched weight
+// tensor on every step. The grouped-convolution lowering re-runs its
+// reshape_dim_into sequence on the weight each time, which copies the whole
+// ensemble's parameters, and handing cuDNN a freshly-allocated weight for the
+// same physical configuration is what keeps re-triggering algorithm search in
+// benchmark mode. We cache the prepared weight keyed by the source TensorImpl
+// and its version counter: until the weights are mutated, the rule hands the
+// backend the exact same physical tensor, so the reshape copies disappear and
+// the backend's own plan cache stays warm. The cache is small and guarded by
+// a mutex; entries are dropped when the source tensor dies or is mutated.
+namespace {
+
+using WeakTensorImplPtr =
+    c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl>;
+
+struct PreparedConvWeight {
+  WeakTensorImplPtr src;
+  uint32_t version;
+  int64_t bdim;
+  int64_t groups;
+  bool transposed;
+  // Distinguishes which lowering prepared the weight; the same (bdim, groups,
+  // transposed) triple can want different layouts in different branches.
+  int64_t mode;
+  Tensor prepared;
+};
+
+std::mutex conv_weight_cache_mutex;
+std::unordered_map<const c10::TensorImpl*, PreparedConvWeight> conv_weight_cache;
+constexpr size_t kConvWeightCacheMaxSize = 64;
+
+template <typename PrepareFn>
+Tensor preparedConvWeight(
+    const Tensor& weight, int64_t bdim, int64_t groups, bool transposed,
+    int64_t mode, PrepareFn prepare) {
+  auto* impl = weight.unsafeGetTensorImpl();
+  if (!impl->version_counter().enabled()) {
+    // Inference tensors don't track a version counter (reading it throws),
+    // so we can't tell when they're mutated; skip the cache for them.
+    return prepare();
+  }
+  const auto version = impl->version_counter().current_version();
+  {
+    std::lock_guard<std::mutex> guard(conv_weight_cache_mutex);
+    auto it = conv_weight_cache.find(impl);
+    if (it != conv_weight_cache.end()) {
+      const auto& entry = it->second;
+      if (entry.version == version && entry.bdim == bdim &&
+          entry.groups == groups && entry.transposed == transposed &&
+          entry.mode == mode && !entry.src.expired()) {
+        return entry.prepared;
+      }
+      conv_weight_cache.erase(it);
+    }
+  }
+  auto prepared = prepare();
+  {
+    std::lock_guard<std::mutex> guard(conv_weight_cache_mutex);
+    if (conv_weight_cache.size() >= kConvWeightCacheMaxSize) {
+      // Drop entries whose source weight is gone; if that frees nothing,
+      // clear everything rather than track recency for a cache this small.
+      for (auto it = conv_weight_cache.begin(); it != conv_weight_cache.end();) {
+        it = it->second.src.expired() ? conv_weight_cache.erase(it) : std::next(it);
+      }
+      if (conv_weight_cache.size() >= kConvWeightCacheMaxSize) {
+        conv_weight_cache.clear();
+      }
+    }
+    conv_weight_cache.emplace(impl, PreparedConvWeight{
+        WeakTensorImplPtr(weight.getIntrusivePtr()),
+        version, bdim, groups, transposed, mode, prepared});
+  }
+  return prepared;
+}
+
+} // namespace
+
 // convolution_batch_rule translated from jax with modifications:
 // https://github.com/google/jax/blob/master/jax/_src/lax/lax.py#L3143
 
@@ -46,16 +126,21 @@ convolution_batch_rule(const Tensor& lhs, optional<int64_t> lhs_bdim, const Tens
     out = reshape_dim_outof(out_spec[0], lhs.sizes()[*lhs_bdim], out);
     result = std::make_tuple(out, out_spec[0]);
   } else if (!lhs_bdim && rhs_bdim) {
+    // See NOTE: [Conv plan reuse for batched weights]
     if (groups == 1) {
-      auto new_w = reshape_dim_into(*rhs_bdim, rhs_spec[0], rhs);
+      auto new_w = preparedConvWeight(rhs, *rhs_bdim, groups, transposed, 0, [&] {
+        return reshape_dim_into(*rhs_bdim, rhs_spec[0], rhs);
+      });
       auto out = at::convolution(lhs, new_w, unbatched_bias, stride, padding, dilation, transposed, output_padding, groups);
       out = reshape_dim_outof(out_spec[1], rhs.sizes()[*rhs_bdim], out);
       result = std::make_tuple(out, out_spec[1]);
     } else {
-      auto dim_with_groups = transposed ? 1 : 0;
-      auto new_w = reshape_dim_outof(rhs_spec[dim_with_groups] + (*rhs_bdim <= rhs_spec[0]), groups, rhs);
-      new_w = reshape_dim_into(*rhs_bdim + (rhs_spec[0] < rhs_bdim), rhs_spec[0] + 1, new_w);
-      new_w = reshape_dim_into(rhs_spec[0], rhs_spec[0], new_w);
+      auto new_w = preparedConvWeight(rhs, *rhs_bdim, groups, transposed, 1, [&] {
+        auto dim_with_groups = transposed ? 1 : 0;
+        auto w = reshape_dim_outof(rhs_spec[dim_with_groups] + (*rhs_bdim <= rhs_spec[0]), groups, rhs);
+        w = reshape_dim_into(*rhs_bdim + (rhs_spec[0] < rhs_bdim), rhs_spec[0] + 1, w);
+        return reshape_dim_into(rhs_spec[0], rhs_spec[0], w);
+      });
       auto out = at::convolution(lhs, new_w, unbatched_bias, stride, padding, dilation, transposed, output_padding, groups);
       out = reshape_dim_outof(out_spec[1], groups, out);
       out = reshape_dim_outof(out_spec[1] + 1, rhs.sizes()[*rhs_bdim], out);
@@ -63,13 +148,37 @@ convolution_batch_rule(const Tensor& lhs, optional<int64_t> lhs_bdim, const Tens
       result = std::make_tuple(out, out_spec[1]);
     }
   } else if (lhs_bdim && rhs_bdim) {
-    auto new_x = reshape_dim_into(*lhs_bdim, lhs_spec[1], lhs);
-    groups *= lhs.sizes()[*lhs_bdim];
-    auto dim_with_groups = transposed ? 1 : 0;
-    auto new_w = reshape_dim_into(*rhs_bdim, rhs_spec[dim_with_groups], rhs);
-    auto out = at::convolution(new_x, new_w, unbatched_bias, stride, padding, dilation, transposed, output_padding, groups);
-    out = reshape_dim_outof(out_spec[1], lhs.sizes()[*lhs_bdim], out);
-    result = std::make_tuple(out, out_spec[1]);
+    // A batched 1x1 conv is a per-lane channel contraction; lower it to one
+    // broadcasted matmul instead of a grouped conv. This skips the grouped
+    // plan entirely and the reshape copies of both operands (the flattens
+    // below are views on contiguous inputs).
+    const auto num_spatial = static_cast<int64_t>(stride.size());
+    bool pointwise = !transposed && groups == 1;
+    auto w = moveBatchDimToFront(rhs, rhs_bdim); // B, O, I, *kernel
+    for (const auto i : c10::irange(num_spatial)) {
+      pointwise = pointwise && w.size(3 + i) == 1 && stride[i] == 1 &&
+          padding[i] == 0 && dilation[i] == 1;
+    }
+    if (pointwise) {
+      auto x = moveBatchDimToFront(lhs, lhs_bdim);               // B, N, I, *spatial
+      const auto spatial_sizes = x.sizes().slice(3, num_spatial);
+      auto x_mat = x.flatten(3, x.dim() - 1);                    // B, N, I, S
+      auto w_mat = w.flatten(2, w.dim() - 1).unsqueeze(1);       // B, 1, O, I
+      auto out = at::matmul(w_mat, x_mat);                       // B, N, O, S
+      out = out.unflatten(-1, spatial_sizes);
+      result = std::make_tuple(out, 0);
+    } else {
+      auto new_x = reshape_dim_into(*lhs_bdim, lhs_spec[1], lhs);
+      groups *= lhs.sizes()[*lhs_bdim];
+      auto dim_with_groups = transposed ? 1 : 0;
+      // See NOTE: [Conv plan reuse for batched weights]
+      auto new_w = preparedConvWeight(rhs, *rhs_bdim, groups, transposed, 2, [&] {
+        return reshape_dim_into(*rhs_bdim, rhs_spec[dim_with_groups], rhs);
+      });
+      auto out = at::convolution(new_x, new_w, unbatched_bias, stride, padding, dilation, transposed, output_padding, groups);
+      out = reshape_dim_outof(out_spec[1], lhs.sizes()[*lhs_bdim], out);
+      result = std::make_tuple(out, out_spec[1]);
+    }
   } else {
     result = std::make_tuple(at::convolution(lhs, rhs, unbatched_bias, stride, padding, dilation, transposed, output_padding, groups), nullopt);
   }
@@ -297,6 +406,30 @@ convolution_backward_weight_batch_rule(
     IntArrayRef output_padding, int64_t groups) {
   const std::array<bool, 3> mask = {false, true, false};
   if (grad_output_bdim && input_bdim) {
+    // NOTE: [Per-sample conv grad via unfold]
+    // vmap(grad(...)) for per-sample gradients lands here with both
+    // grad_output and input batched and the weight unbatched. The grouped
+    // lowering below runs convolution_backward with groups * B, which the
+    // backends handle poorly at large B. For ordinary 2-d convs we instead
+    // use the unfold formulation (same as opacus, and the commented-out
+    // cudnn rule above): im2col the input once and contract against
+    // grad_output with a single bmm.
+    if (!transposed && groups == 1 && weight.dim() == 4 &&
+        input.dim() - 1 == 4) {
+      const auto batch_size = input.size(*input_bdim);
+      auto grad_output_ = moveBatchDimToFront(grad_output, grad_output_bdim); // [B, N, O, oh, ow]
+      auto input_ = moveBatchDimToFront(input, input_bdim);                   // [B, N, C, ih, iw]
+      const auto num_channels = input_.size(2);
+      const auto kh = weight.size(2);
+      const auto kw = weight.size(3);
+      const auto unfolded = at::im2col(
+          input_.flatten(0, 1), {kh, kw}, dilation, padding, stride); // [BN, C*kh*kw, L]
+      const auto g = grad_output_.flatten(0, 1).flatten(2);           // [BN, O, L]
+      auto grad_weight = at::bmm(g, unfolded.transpose(1, 2));        // [BN, O, C*kh*kw]
+      grad_weight = grad_weight.unflatten(0, {batch_size, input_.size(1)}).sum(1);
+      grad_weight = grad_weight.unflatten(2, {num_channels, kh, kw}); // [B, O, C, kh, kw]
+      return std::make_tuple(grad_weight, 0);
+    }
     // BNO, BNI -> N(BO), N(BI) -> (BO)I (regular) (BI)O (transposed)
     const auto batch_size = input.size(*input_bdim);
     const auto grad_output_ = reshape_dim_into(*grad_output_bdim, 1, grad_output);
@@ -81,6 +81,27 @@ static std::tuple<Tensor, optional<int64_t>> mm_batch_rule(
       "but expected them to have dim 2 and dim 2");
   auto self_ = moveBatchDimToFront(self, self_bdim);
   auto other_ = moveBatchDimToFront(other, other_bdim);
+  // See Note [Batching rules for matmul-like operators]. We go further than
+  // not expanding: pick the lowering per batched side so the unbatched
+  // operand is never materialized.
+  if (self_bdim && !other_bdim) {
+    // [B, n, k] @ [k, m]: fold the lanes into rows and issue one mm.
+    if (self_.is_contiguous()) {
+      const auto out = at::mm(self_.view({-1, self_.size(2)}), other_);
+      return std::make_tuple(reshape_dim_outof(0, self_.size(0), out), 0);
+    }
+    return std::make_tuple(at::matmul(self_, other_), 0);
+  }
+  if (!self_bdim && other_bdim) {
+    // [n, k] @ [B, k, m]: hand bmm a stride-0 broadcast of the lhs. Backends
+    // consume broadcast batch strides directly; if one genuinely can't, it
+    // makes the copy itself -- we don't materialize up front.
+    const auto lhs = self_.expand({other_.size(0), self_.size(0), self_.size(1)});
+    return std::make_tuple(at::bmm(lhs, other_), 0);
+  }
+  if (self_bdim && other_bdim) {
+    return std::make_tuple(at::bmm(self_, other_), 0);
+  }
   return std::make_tuple( at::matmul(self_, other_), 0 );
 }
 
@@ -96,6 +117,18 @@ static std::tuple<Tensor, optional<int64_t>> bmm_batch_rule(
       "but expected them to have dim 3 and dim 3");
   auto self_ = moveBatchDimToFront(self, self_bdim);
   auto other_ = moveBatchDimToFront(other, other_bdim);
+  if (self_bdim && other_bdim) {
+    // [B, b, n, k] @ [B, b, k, m]: fold the two batch dims and issue a
+    // single bmm instead of bouncing back through matmul's broadcasting.
+    const auto B = self_.size(0);
+    const auto out = at::bmm(
+        self_.reshape({-1, self_.size(2), self_.size(3)}),
+        other_.reshape({-1, other_.size(2), other_.size(3)}));
+    return std::make_tuple(reshape_dim_outof(0, B, out), 0);
+  }
+  // One-sided cases stay on matmul: the logical operands are already 3-d,
+  // so folding the lane dim with the unbatched side's batch dim can't be
+  // expressed as a view, and forcing it would materialize the broadcast.
   return std::make_tuple( at::matmul(self_, other_), 0 );
 }
 
@@ -66,6 +66,7 @@ batch_norm_batch_rule(
   Tensor result0;
   Tensor mean;
   Tensor rstd;
+  bool fused_affine = false;
   if (!input_bdim && !running_mean_bdim && !running_var_bdim) {
     const auto dummy_weight = at::ones(input.size(1), input.options());  // cudnn and miopen require a weight
     const auto dummy_bias = at::zeros(input.size(1), input.options());   // without this, get "strides() called on undefined Tensor" on cuda
@@ -92,9 +93,26 @@ batch_norm_batch_rule(
       running_var_ = reshape_dim_into(0, 0, *running_var_);
     }
 
-    const auto dummy_weight = at::ones(input_.size(1), input_.options());  // cudnn and miopen require a weight
-    const auto dummy_bias = at::zeros(input_.size(1), input_.options());   // without this, get "strides() called on undefined Tensor" on cuda
-    const auto result = Func(input_, dummy_weight, dummy_bias, running_mean_, running_var_, training, momentum, eps);
+    // NOTE: [Fused affine in the batch_norm batch rule]
+    // The lane dim is already folded into the channel dim here, so when
+    // weight/bias aren't batched (the per-sample-grad case) we can tile them
+    // across the (B0, C) channels and let the fused kernel apply them,
+    // instead of paying separate full-size mul/add launches afterwards.
+    // Tiling only copies a 1-d per-channel tensor.
+    fused_affine = !weight_bdim && !bias_bdim;
+    Tensor kernel_weight;
+    Tensor kernel_bias;
+    if (fused_affine && weight.defined()) {
+      kernel_weight = weight.repeat(bdim_size.value());
+    } else {
+      kernel_weight = at::ones(input_.size(1), input_.options());  // cudnn and miopen require a weight
+    }
+    if (fused_affine && bias.defined()) {
+      kernel_bias = bias.repeat(bdim_size.value());
+    } else {
+      kernel_bias = at::zeros(input_.size(1), input_.options());   // without this, get "strides() called on undefined Tensor" on cuda
+    }
+    const auto result = Func(input_, kernel_weight, kernel_bias, running_mean_, running_var_, training, momentum, eps);
     result0 = std::get<0>(result).transpose(0, 1);                // [(B0, C), B, *]
     result0 = reshape_dim_outof(0, bdim_size.value(), result0);   // [B0, C, B, *]
     mean = std::get<1>(result);
@@ -104,13 +122,13 @@ batch_norm_batch_rule(
   }
 
   const auto stats_bdim = compute_stat_bdim(bdim_size, mean);
-  if (weight.defined()) {
+  if (weight.defined() && !fused_affine) {
     const auto input_logical_rank = rankWithoutBatchDim(input, input_bdim);
     auto weight_ = moveBatchDimToFront(weight, weight_bdim);
     weight_ = padRight(weight_, weight_bdim, input_logical_rank);
     result0 = result0 * weight_;
   }
-  if (bias.defined()) {
+  if (bias.defined() && !fused_affine) {
     const auto result_logical_rank = rankWithoutBatchDim(
         result0,
         bdim_size.has_value() || weight_bdim.has_value() ? optional<int64_t>(0) : optional<int64_t>(nullopt));
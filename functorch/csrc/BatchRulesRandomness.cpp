@@ -11,6 +11,77 @@
 namespace at {
 namespace functorch {
 
+// NOTE: [Counter-based per-sample streams]
+// RandomnessType::Different promises per-lane randomness, but drawing all
+// lanes from one sequential stream ties lane i's values to the batch size:
+// regroup the same samples into a different B and every lane sees different
+// numbers. When the caller passes an explicit Generator, the in-place rules
+// below instead derive one stream per lane from a counter-based (Philox-style)
+// hash of (seed, level, lane index). Any lane's seed is computable directly
+// from its index with no sequential state, so per-sample noise (e.g. DP-SGD)
+// is reproducible no matter how the samples are batched. The per-lane draws
+// write straight into slices of the batched tensor -- no intermediate buffer
+// and no copy_ -- at the cost of one launch per lane.
+static uint64_t mix64(uint64_t x) {
+  // splitmix64 finalizer
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+static uint64_t perLaneSeed(uint64_t seed, int64_t level, int64_t lane) {
+  const uint64_t golden = 0x9e3779b97f4a7c15ull;
+  return mix64(mix64(seed + golden * static_cast<uint64_t>(level)) + static_cast<uint64_t>(lane));
+}
+
+// True if the last of Ts... is c10::optional<Generator>. All of the random
+// in-place ops we register take their generator as the trailing argument.
+template <typename... Ts>
+struct trailing_is_generator : std::false_type {};
+
+template <typename T1, typename... Ts>
+struct trailing_is_generator<T1, Ts...> {
+  static constexpr bool value = std::is_same<
+      typename std::tuple_element<sizeof...(Ts), std::tuple<T1, Ts...>>::type,
+      c10::optional<Generator>>::value;
+};
+
+template <typename F, F Func, typename... ExtraArgs, size_t... Is>
+static void callWithLaneGenerator(
+    Tensor& slice, Generator lane_gen,
+    std::tuple<ExtraArgs&...> args, std::index_sequence<Is...>) {
+  Func(slice, std::get<Is>(args)..., c10::optional<Generator>(std::move(lane_gen)));
+}
+
+// Fills each lane of `self_batched` (batch dim at the front) from its own
+// derived stream. Returns false (and does nothing) if the caller didn't pass
+// a generator; sequential default-generator behavior is kept in that case.
+template <typename F, F Func, typename... ExtraArgs>
+static typename std::enable_if<trailing_is_generator<ExtraArgs...>::value, bool>::type
+perSampleRandomInplace(Tensor& self_batched, int64_t level, ExtraArgs&... extra_args) {
+  auto args = std::tie(extra_args...);
+  const auto& maybe_gen = std::get<sizeof...(ExtraArgs) - 1>(args);
+  if (!maybe_gen.has_value() || !maybe_gen->defined()) {
+    return false;
+  }
+  const auto seed = maybe_gen->current_seed();
+  for (const auto lane : c10::irange(self_batched.size(0))) {
+    auto lane_gen = maybe_gen->clone();
+    lane_gen.set_current_seed(perLaneSeed(seed, level, lane));
+    auto slice = self_batched.select(0, lane);
+    callWithLaneGenerator<F, Func, ExtraArgs...>(
+        slice, std::move(lane_gen), args,
+        std::make_index_sequence<sizeof...(ExtraArgs) - 1>{});
+  }
+  return true;
+}
+
+template <typename F, F Func, typename... ExtraArgs>
+static typename std::enable_if<!trailing_is_generator<ExtraArgs...>::value, bool>::type
+perSampleRandomInplace(Tensor&, int64_t, ExtraArgs&...) {
+  return false;
+}
+
 template <typename F, F Func, typename... ExtraArgs>
 Tensor random_batching_rule(IntArrayRef shape, ExtraArgs... extra_args) {
   c10::impl::ExcludeDispatchKeyGuard guard(kVmapModeKey);
@@ -48,6 +119,12 @@ Tensor& random_inplace_batching_rule(Tensor& self, ExtraArgs... extra_args) {
     self.copy_(intermediate); // batching should make this just work out...
     return self;
   } else {
+    // See NOTE: [Counter-based per-sample streams]
+    if (randomness == RandomnessType::Different &&
+        perSampleRandomInplace<F, Func, ExtraArgs...>(
+            self_value, maybe_layer->layerId(), extra_args...)) {
+      return self;
+    }
     Func(self_value, std::forward<ExtraArgs>(extra_args)...);
     return self;
   }
@@ -97,6 +174,18 @@ Tensor& bernoulli_inplace_Tensor_batching_rule(Tensor& self, const Tensor& p_, c
     self.copy_(intermediate); // batching should make this just work out...
     return self;
   } else {
+    // See NOTE: [Counter-based per-sample streams]
+    if (randomness == RandomnessType::Different && gen.has_value() && gen->defined()) {
+      const auto seed = gen->current_seed();
+      for (const auto lane : c10::irange(self_.size(0))) {
+        auto lane_gen = gen->clone();
+        lane_gen.set_current_seed(perLaneSeed(seed, cur_level, lane));
+        auto self_slice = self_.select(0, lane);
+        auto p_slice = other_bdim.has_value() ? other_.select(0, lane) : other_;
+        self_slice.bernoulli_(p_slice, lane_gen);
+      }
+      return self;
+    }
     self_.bernoulli_(other_, gen);
     return self;
   }
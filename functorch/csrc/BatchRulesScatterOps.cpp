@@ -702,21 +702,50 @@ std::tuple<Tensor,optional<int64_t>> index_add_batch_rule(
     return std::make_tuple(result, 0);
   }
 
-  // Index is batched. For-loop and stack is the best thing I can come up with
-  // right now. We really want generalized index_add kernel in PyTorch
+  // NOTE: [Flattened batched index_add]
+  // Index is batched. This used to lower to a per-lane for-loop + stack:
+  // O(B) kernel launches plus a full-size copy. index_add requires
+  // non-negative indices, so instead we can offset lane i's indices by
+  // i * size(dim), fold the lane dim into the indexed dim, and issue a
+  // single index_add over the physical tensor. The offsets keep lanes
+  // disjoint, so per-lane accumulation semantics are preserved.
+  const auto self_logical_rank = rankWithoutBatchDim(self, self_bdim);
+  const auto index_logical_rank = rankWithoutBatchDim(index, index_bdim);
+  const auto other_logical_rank = rankWithoutBatchDim(other, other_bdim);
+  dim = maybe_wrap_dim(dim, self_logical_rank);
+
   auto batch_size = get_bdim_size3(self, self_bdim, other, other_bdim, index, index_bdim);
-  std::vector<Tensor> results;
-  results.reserve(batch_size);
-  for (const auto i : c10::irange(0, batch_size)) {
-    const auto& self_slice = self_bdim.has_value() ?
-      self.select(*self_bdim, i) : self;
-    const auto& other_slice = other_bdim.has_value() ?
-      other.select(*other_bdim, i) : other;
-    const auto& index_slice = index_bdim.has_value() ?
-      index.select(*index_bdim, i) : index;
-    results.push_back(at::index_add(self_slice, dim, index_slice, other_slice, alpha));
-  }
-  return std::make_tuple(at::stack(results), 0);
+  auto self_ = moveBatchDimToFront(self, self_bdim);
+  if (self_logical_rank == 0) {
+    self_ = self_.unsqueeze(-1);
+  }
+  self_ = ensure_has_bdim(self_, self_bdim.has_value(), batch_size);
+  auto other_ = moveBatchDimToFront(other, other_bdim);
+  if (other_logical_rank == 0) {
+    other_ = other_.unsqueeze(-1);
+  }
+  other_ = ensure_has_bdim(other_, other_bdim.has_value(), batch_size);
+  auto index_ = moveBatchDimToFront(index, index_bdim);
+  if (index_logical_rank == 0) {
+    index_ = index_.unsqueeze(-1);
+  }
+  index_ = ensure_has_bdim(index_, index_bdim.has_value(), batch_size);  // [B, K]
+
+  const auto indexed_size = self_.size(dim + 1);
+  const auto offsets = at::arange(batch_size, index_.options()) * indexed_size;
+  index_ = (index_ + offsets.unsqueeze(-1)).flatten();  // [B * K]
+
+  // Fold the lane dim into the indexed dim. When dim is the leading logical
+  // dim (the embedding-update case) these flattens are views.
+  auto flat_self = self_.movedim(dim + 1, 1).flatten(0, 1);    // [B * N, *rest]
+  auto flat_other = other_.movedim(dim + 1, 1).flatten(0, 1);  // [B * K, *rest]
+  auto result = flat_self.index_add(0, index_, flat_other, alpha);
+  result = result.unflatten(0, {batch_size, indexed_size});
+  result = result.movedim(1, dim + 1);
+  if (self_logical_rank == 0) {
+    result = result.squeeze(-1);
+  }
+  return std::make_tuple(result, 0);
 }
 
 TORCH_LIBRARY_IMPL(aten, FT_BATCHED_KEY, m) {
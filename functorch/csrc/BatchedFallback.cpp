@@ -10,14 +10,23 @@
 #include <functorch/csrc/TensorWrapper.h>
 #include <functorch/csrc/DynamicLayer.h>
 #include <functorch/csrc/PlumbingHelper.h>
+#include <functorch/csrc/TransformTracing.h>
+#include <functorch/csrc/Decompositions.h>
 
 #include <ATen/Context.h>
 #include <ATen/MatrixRef.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/dispatch/Dispatcher.h>
+#include <c10/core/Event.h>
+#include <c10/core/StreamGuard.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
 #include <c10/util/accumulate.h>
 #include <c10/util/llvmMathExtras.h>
 #include <c10/util/irange.h>
 
+#include <chrono>
+#include <mutex>
+
 namespace at {
 namespace functorch {
 
@@ -41,20 +50,122 @@ void setVmapFallbackEnabled(bool enabled) {
   kVmapFallbackEnabled = enabled;
 }
 
-// Given a linear index, return the actual index.
-// Example: Given linear_idx = 3, sizes = [5, 2], we would return [1, 0]
-static at::SmallVector<indexing::TensorIndex,kVmapStaticDimVecSize>
-computeIndex(int64_t linear_idx, IntArrayRef sizes) {
-  at::SmallVector<indexing::TensorIndex,kVmapStaticDimVecSize> result;
-  result.reserve(sizes.size());
-  for (auto it = sizes.rbegin(); it != sizes.rend(); it++) {
-    auto remainder = linear_idx % *it;
-    result.push_back(remainder);
-    linear_idx -= remainder;
-    linear_idx /= *it;
+bool kVmapFallbackParallelEnabled = false;
+
+bool isVmapFallbackParallelEnabled() {
+  return kVmapFallbackParallelEnabled;
+}
+
+void setVmapFallbackParallelEnabled(bool enabled) {
+  kVmapFallbackParallelEnabled = enabled;
+}
+
+bool kVmapFallbackPreallocateOutputsEnabled = false;
+
+bool isVmapFallbackPreallocateOutputsEnabled() {
+  return kVmapFallbackPreallocateOutputsEnabled;
+}
+
+void setVmapFallbackPreallocateOutputsEnabled(bool enabled) {
+  kVmapFallbackPreallocateOutputsEnabled = enabled;
+}
+
+bool kVmapFallbackDecomposeEnabled = false;
+
+bool isVmapFallbackDecomposeEnabled() {
+  return kVmapFallbackDecomposeEnabled;
+}
+
+void setVmapFallbackDecomposeEnabled(bool enabled) {
+  kVmapFallbackDecomposeEnabled = enabled;
+}
+
+bool kVmapFallbackStreamsEnabled = false;
+
+bool isVmapFallbackStreamsEnabled() {
+  return kVmapFallbackStreamsEnabled;
+}
+
+void setVmapFallbackStreamsEnabled(bool enabled) {
+  kVmapFallbackStreamsEnabled = enabled;
+}
+
+// Runs `slice_task(linear_idx)` for every linear index in [0, num_batches).
+// If the parallel fallback is enabled, the indices are partitioned over
+// at::parallel_for; slice_task must write to disjoint state per index.
+// NB: at::parallel_for propagates ThreadLocalState (and therefore the
+// dispatch TLS the fallback relies on) to its workers.
+static void forEachBatchSlice(int64_t num_batches, const std::function<void(int64_t)>& slice_task) {
+  if (isVmapFallbackParallelEnabled() && num_batches > 1) {
+    at::parallel_for(0, num_batches, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t linear_idx = begin; linear_idx < end; ++linear_idx) {
+        slice_task(linear_idx);
+      }
+    });
+    return;
+  }
+  for (int64_t linear_idx = 0; linear_idx < num_batches; ++linear_idx) {
+    slice_task(linear_idx);
   }
-  std::reverse(std::begin(result), std::end(result));
-  return result;
+}
+
+static std::mutex kVmapFallbackStatsMutex;
+static std::unordered_map<std::string, VmapFallbackOpStats> kVmapFallbackStats;
+
+std::unordered_map<std::string, VmapFallbackOpStats> getVmapFallbackStats() {
+  std::lock_guard<std::mutex> guard(kVmapFallbackStatsMutex);
+  return kVmapFallbackStats;
+}
+
+void resetVmapFallbackStats() {
+  std::lock_guard<std::mutex> guard(kVmapFallbackStatsMutex);
+  kVmapFallbackStats.clear();
+}
+
+namespace {
+// RAII recorder for VmapFallbackOpStats; construct it once the slice count
+// is known and it records on destruction (i.e. after the slice loop ran).
+// The fallback is the slow path already, so one uncontended lock per
+// fallback invocation (not per slice) is in the noise.
+struct VmapFallbackStatsRecorder {
+  VmapFallbackStatsRecorder(const c10::FunctionSchema& schema, int64_t num_batches)
+    : schema_(schema), num_batches_(num_batches),
+      start_(std::chrono::steady_clock::now()) {}
+  ~VmapFallbackStatsRecorder() {
+    auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    std::lock_guard<std::mutex> guard(kVmapFallbackStatsMutex);
+    auto& stats = kVmapFallbackStats[toString(schema_.operator_name())];
+    stats.num_calls += 1;
+    stats.total_ns += elapsed_ns;
+    stats.total_batches += num_batches_;
+    stats.max_batch_size = std::max(stats.max_batch_size, num_batches_);
+  }
+
+  const c10::FunctionSchema& schema_;
+  int64_t num_batches_;
+  std::chrono::steady_clock::time_point start_;
+};
+} // namespace
+
+// Given a linear index into the batch dims of `tensor`, return the slice
+// tensor[i0][i1]...[ik] over the leading batch dims, where [i0, ..., ik] is
+// the linear index unflattened against `batch_sizes`.
+// Equivalent to building a TensorIndex list and calling Tensor::index, but
+// computes the storage offset directly: one as_strided view per slice
+// instead of the advanced-indexing machinery and its per-call scratch.
+static Tensor selectBatchDims(const Tensor& tensor, int64_t linear_idx, IntArrayRef batch_sizes) {
+  const auto sizes = tensor.sizes();
+  const auto strides = tensor.strides();
+  const int64_t num_batch_dims = batch_sizes.size();
+  int64_t offset = tensor.storage_offset();
+  for (int64_t dim = num_batch_dims - 1; dim >= 0; dim--) {
+    auto remainder = linear_idx % batch_sizes[dim];
+    offset += remainder * strides[dim];
+    linear_idx /= batch_sizes[dim];
+  }
+  return tensor.as_strided(
+      sizes.slice(num_batch_dims), strides.slice(num_batch_dims), offset);
 }
 
 static bool areAllReturnsTensors(const at::FunctionSchema& schema) {
@@ -98,6 +209,11 @@ static void warnFallback(const c10::FunctionSchema& schema, bool is_inplace) {
 //   the operator, and then pop the results off the stack.
 void batchedTensorInplaceForLoopFallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
   const auto& schema = op.schema();
+  // See NOTE: [Transform event tracing]
+  const auto maybe_layer = maybeCurrentDynamicLayer();
+  TransformTraceGuard trace_guard(
+      schema.name().c_str(), kBatchedKey,
+      maybe_layer.has_value() ? maybe_layer->layerId() : -1);
   warnFallback(schema, /*in_place*/true);
 
   const auto num_arguments = schema.arguments().size();
@@ -181,10 +297,14 @@ void batchedTensorInplaceForLoopFallback(const c10::OperatorHandle& op, torch::j
       "Batching rule not implemented for ", schema.operator_name(), ". ",
       "The fallback path does not support vmap over dims of size 0.");
 
+  VmapFallbackStatsRecorder stats_recorder(schema, num_batches);
+
   // Strategy: For each batch, we are going to push slices (where applicable)
-  // of the arguments onto `stack`, and call `op`.
-  for (int64_t linear_idx = 0; linear_idx < num_batches; ++linear_idx) {
-    auto index = computeIndex(linear_idx, batch_sizes);
+  // of the arguments onto a per-slice stack, and call `op`. The slices of
+  // `self` are disjoint, so the slices may run in parallel.
+  forEachBatchSlice(num_batches, [&](int64_t linear_idx) {
+    torch::jit::Stack slice_stack;
+    slice_stack.reserve(num_arguments);
     auto batched_tensor_inputs_pos_iter = batched_tensor_inputs_position.begin();
     auto input_physical_views_iter = input_physical_views.begin();
     for (const auto arg_idx : c10::irange(0, num_arguments)) {
@@ -194,21 +314,21 @@ void batchedTensorInplaceForLoopFallback(const c10::OperatorHandle& op, torch::j
       if (batched_tensor_inputs_pos_iter == batched_tensor_inputs_position.end()
           || (int64_t)arg_idx != *batched_tensor_inputs_pos_iter) {
         // argument isn't a BatchedTensor
-        torch::jit::push(stack, argument);
+        torch::jit::push(&slice_stack, argument);
         continue;
       }
       // argument is a BatchedTensor
       TORCH_INTERNAL_ASSERT(input_physical_views_iter != input_physical_views.end());
       const auto& physical_view_for_argument = *input_physical_views_iter;
-      auto thing = physical_view_for_argument.tensor().index(index);
-      torch::jit::push(stack, thing);
+      auto thing = selectBatchDims(
+          physical_view_for_argument.tensor(), linear_idx, batch_sizes);
+      torch::jit::push(&slice_stack, thing);
       batched_tensor_inputs_pos_iter++;
       input_physical_views_iter++;
     }
 
-    op.callBoxed(stack);
-    torch::jit::drop(stack, 1);
-  }
+    op.callBoxed(&slice_stack);
+  });
 
   // Return the tensor that was written to in-place
   torch::jit::drop(stack, num_arguments);
@@ -259,6 +379,11 @@ static Tensor safeStack(TensorList tensors) {
 //   so we stack those tensors together to form the final result.
 void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
   const auto& schema = op.schema();
+  // See NOTE: [Transform event tracing]
+  const auto maybe_layer = maybeCurrentDynamicLayer();
+  TransformTraceGuard trace_guard(
+      schema.name().c_str(), kBatchedKey,
+      maybe_layer.has_value() ? maybe_layer->layerId() : -1);
   const auto num_returns = schema.returns().size();
   const auto num_arguments = schema.arguments().size();
   const auto arguments = torch::jit::last(stack, num_arguments);
@@ -277,6 +402,13 @@ void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Sta
     batchedTensorInplaceForLoopFallback(op, stack);
     return;
   }
+  // See NOTE: [Runtime decomposition registry]: rewriting the op in terms of
+  // batch-rule-covered primitives beats slicing it batch_size times, so try
+  // that before warning and entering the loop. The decomposition re-enters
+  // the dispatcher, so nested vmap levels are handled as usual.
+  if (isVmapFallbackDecomposeEnabled() && runDecomposition(op, stack)) {
+    return;
+  }
   TORCH_CHECK(!schema.is_mutable() && !schema.hasAnyAliasInfo(),
               "Batching rule not implemented for ", schema.operator_name(), "; ",
               "the fallback path doesn't work on out= or view ops.");
@@ -325,20 +457,17 @@ void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Sta
       "Batching rule not implemented for ", schema.operator_name(), ". ",
       "The fallback path does not support vmap over dims of size 0.");
 
+  VmapFallbackStatsRecorder stats_recorder(schema, num_batches);
+
   // Strategy: For each batch, we are going to push slices (where applicable)
-  // of the arguments onto `stack`, call `op`, and store the result in
-  // `output_shards`.
+  // of the arguments onto a fresh stack, call `op`, and collect the result.
   //
-  // NOTE: [Output shards layout]
-  // Assume that the operator has three outputs: a, b, c.
-  // The layout of output_shards is as follows:
-  // [ a0, a1, a2, a3, b0, b1, b2, b3, c0, c1, c2, c3]
-  // This is so that we can call at::stack([a0...a3]), at::stack([b0...b3])
-  // more easily in the next step.
-  std::vector<Tensor> output_shards(num_batches * num_returns);
-
-  for (int64_t linear_idx = 0; linear_idx < num_batches; ++linear_idx) {
-    auto index = computeIndex(linear_idx, batch_sizes);
+  // Pushes slice `linear_idx` of every argument onto `slice_stack` and
+  // invokes the operator; the outputs are left on `slice_stack`. Each slice
+  // invocation gets its own stack (rather than pushing/popping on `stack`)
+  // so that slices may run on at::parallel_for workers.
+  auto call_op_on_slice = [&](int64_t linear_idx, torch::jit::Stack& slice_stack) {
+    slice_stack.reserve(num_arguments);
     auto batched_tensor_inputs_pos_iter = batched_tensor_inputs_position.begin();
     auto input_physical_views_iter = input_physical_views.begin();
     for (const auto arg_idx : c10::irange(0, num_arguments)) {
@@ -348,31 +477,157 @@ void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Sta
       if (batched_tensor_inputs_pos_iter == batched_tensor_inputs_position.end()
           || (int64_t)arg_idx != *batched_tensor_inputs_pos_iter) {
         // argument isn't a BatchedTensor
-        torch::jit::push(stack, argument);
+        torch::jit::push(&slice_stack, argument);
         continue;
       }
       // argument is a BatchedTensor
       TORCH_INTERNAL_ASSERT(input_physical_views_iter != input_physical_views.end());
       const auto& physical_view_for_argument = *input_physical_views_iter;
       c10::impl::ExcludeDispatchKeyGuard guard(kBatchedKey);
-      torch::jit::push(stack, physical_view_for_argument.tensor().index(index));
+      torch::jit::push(&slice_stack, selectBatchDims(
+          physical_view_for_argument.tensor(), linear_idx, batch_sizes));
       batched_tensor_inputs_pos_iter++;
       input_physical_views_iter++;
     }
 
-    // std::cout << "[Fallback]: ";
-    // at::dump_tensor((*stack)[stack->size() - 1].toTensor());
     c10::impl::ExcludeDispatchKeyGuard guard(kBatchedKey);
-    op.callBoxed(stack);
+    op.callBoxed(&slice_stack);
+  };
+
+  // Wraps the flat (num_batches, ...) physical output as a logical tensor
+  // and pushes it onto `stack`.
+  auto push_physical_output = [&](const Tensor& flat_output) {
+    VmapDimVector output_sizes(batch_sizes);
+    output_sizes.insert(
+        output_sizes.end(),
+        flat_output.sizes().begin() + 1,
+        flat_output.sizes().end());
+    torch::jit::push(
+        stack,
+        input_physical_views.front().getPhysicalToLogicalMap().apply(flat_output.view(output_sizes)));
+  };
+
+  // NOTE: [Preallocated fallback outputs]
+  // The sharded path below keeps every slice's outputs alive until the final
+  // at::stack, which doubles peak memory and pays one allocator round trip
+  // per slice per output. When enabled, we instead run slice 0 to learn the
+  // output shapes, allocate each stacked output up front, and copy every
+  // slice's results straight into the slab: one allocation per output and no
+  // trailing stack. If slice 0 produces an undefined output (see
+  // NOTE [vmap through backward and undefined grad]) we redo it on the
+  // sharded path; ops reaching here are guaranteed non-mutating, so
+  // re-running slice 0 is safe.
+  if (isVmapFallbackPreallocateOutputsEnabled() || isVmapFallbackStreamsEnabled()) {
+    std::vector<Tensor> output_slabs(num_returns);
+    bool all_defined = true;
+    {
+      torch::jit::Stack slice_stack;
+      call_op_on_slice(0, slice_stack);
+      const auto returns = torch::jit::last(slice_stack, num_returns);
+      for (const auto return_idx : c10::irange(0, returns.size())) {
+        const auto& shard = returns[return_idx].toTensor();
+        if (!shard.defined()) {
+          all_defined = false;
+          break;
+        }
+        c10::impl::ExcludeDispatchKeyGuard guard(kBatchedKey);
+        VmapDimVector slab_sizes;
+        slab_sizes.push_back(num_batches);
+        slab_sizes.insert(slab_sizes.end(), shard.sizes().begin(), shard.sizes().end());
+        output_slabs[return_idx] = at::empty(slab_sizes, shard.options());
+        output_slabs[return_idx].select(0, 0).copy_(shard);
+      }
+    }
+    if (all_defined) {
+      // Runs one slice and copies its outputs into the slabs at
+      // `linear_idx`. Slabs are written at disjoint indices so this is safe
+      // under the parallel and streamed variants alike.
+      auto run_slice_into_slabs = [&](int64_t linear_idx) {
+        torch::jit::Stack slice_stack;
+        call_op_on_slice(linear_idx, slice_stack);
+        const auto returns = torch::jit::last(slice_stack, num_returns);
+        for (const auto return_idx : c10::irange(0, returns.size())) {
+          const auto& shard = returns[return_idx].toTensor();
+          TORCH_CHECK(shard.defined(),
+              "vmap: slow fallback received a mix of undefined and defined tensors ",
+              "as the result of an operation. This is not supported, please file us ",
+              "an issue on github.");
+          c10::impl::ExcludeDispatchKeyGuard guard(kBatchedKey);
+          output_slabs[return_idx].select(0, linear_idx).copy_(shard);
+        }
+      };
+
+      // NOTE: [Streamed CUDA fallback]
+      // On CUDA the sliced loop is stream-serialized: each slice's index
+      // computation, the op's kernels, and the copy into the slab all queue
+      // behind the previous slice on the current stream, even though the
+      // slices are independent. When enabled, round-robin the remaining
+      // slices over a small pool of side streams: each side stream waits on
+      // the point where the inputs (and slice 0's slabs) were ready, the
+      // disjoint slab writes need no ordering among themselves, and the
+      // current stream waits on every side stream before the result
+      // escapes. Per-slice temporaries are allocated and freed on the same
+      // side stream, which the caching allocator orders correctly. Written
+      // against the generic c10 stream/event API so this file builds
+      // without CUDA headers.
+      const auto slab_device = output_slabs[0].device();
+      if (isVmapFallbackStreamsEnabled() && slab_device.is_cuda() &&
+          num_batches > 1) {
+        constexpr int64_t kNumFallbackStreams = 4;
+        c10::impl::VirtualGuardImpl impl(slab_device.type());
+        const auto main_stream = impl.getStream(slab_device);
+        c10::Event inputs_ready(slab_device.type());
+        inputs_ready.record(main_stream);
+        std::vector<c10::Stream> stream_pool;
+        for (C10_UNUSED const auto i :
+             c10::irange(std::min(kNumFallbackStreams, num_batches - 1))) {
+          stream_pool.push_back(impl.getStreamFromGlobalPool(slab_device));
+          inputs_ready.block(stream_pool.back());
+        }
+        for (const auto idx : c10::irange(num_batches - 1)) {
+          c10::StreamGuard stream_guard(stream_pool[idx % stream_pool.size()]);
+          run_slice_into_slabs(idx + 1);
+        }
+        for (const auto& stream : stream_pool) {
+          c10::Event done(slab_device.type());
+          done.record(stream);
+          done.block(main_stream);
+        }
+      } else {
+        // Slice 0 already lives in the slabs.
+        forEachBatchSlice(num_batches - 1, [&](int64_t idx) {
+          run_slice_into_slabs(idx + 1);
+        });
+      }
+      torch::jit::drop(stack, num_arguments);
+      for (const auto return_idx : c10::irange(0, num_returns)) {
+        c10::impl::ExcludeDispatchKeyGuard guard(kBatchedKey);
+        push_physical_output(output_slabs[return_idx]);
+      }
+      return;
+    }
+  }
+
+  // NOTE: [Output shards layout]
+  // Assume that the operator has three outputs: a, b, c.
+  // The layout of output_shards is as follows:
+  // [ a0, a1, a2, a3, b0, b1, b2, b3, c0, c1, c2, c3]
+  // This is so that we can call at::stack([a0...a3]), at::stack([b0...b3])
+  // more easily in the next step.
+  std::vector<Tensor> output_shards(num_batches * num_returns);
+
+  // Each slice writes to disjoint entries of `output_shards`.
+  forEachBatchSlice(num_batches, [&](int64_t linear_idx) {
+    torch::jit::Stack slice_stack;
+    call_op_on_slice(linear_idx, slice_stack);
 
     // Store the result into `output_shards`. See NOTE: [Output shards layout]
     // to learn about the details of how we store the shards.
-    const auto returns = torch::jit::last(stack, num_returns);
+    const auto returns = torch::jit::last(slice_stack, num_returns);
     for (const auto  return_idx : c10::irange(0, returns.size())) {
       output_shards[num_batches * return_idx + linear_idx] = returns[return_idx].toTensor();
     }
-    torch::jit::drop(stack, num_returns);
-  }
+  });
 
   // For each output Tensor, stack the shards of the tensor together to form a return
   torch::jit::drop(stack, num_arguments);
@@ -386,14 +641,7 @@ void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Sta
       torch::jit::push(stack, flat_output);
       continue;
     }
-    VmapDimVector output_sizes(batch_sizes);
-    output_sizes.insert(
-        output_sizes.end(),
-        flat_output.sizes().begin() + 1,
-        flat_output.sizes().end());
-    torch::jit::push(
-        stack,
-        input_physical_views.front().getPhysicalToLogicalMap().apply(flat_output.view(output_sizes)));
+    push_physical_output(flat_output);
   }
 }
 
@@ -33,6 +33,52 @@ void setVmapFallbackWarningEnabled(bool enabled);
 bool isVmapFallbackEnabled();
 void setVmapFallbackEnabled(bool enabled);
 
+// When enabled, the fallback partitions the linear batch-index range with
+// at::parallel_for and runs each slice's op call on its own stack. Off by
+// default: the op called per-slice must be safe to run concurrently.
+bool isVmapFallbackParallelEnabled();
+void setVmapFallbackParallelEnabled(bool enabled);
+
+// When enabled, the sliced fallback preallocates each stacked output after
+// the first slice and copies slice results straight into it, instead of
+// keeping every shard alive for a final at::stack: one allocation per
+// output instead of one per slice, and roughly half the peak memory at
+// large batch sizes. See NOTE: [Preallocated fallback outputs].
+bool isVmapFallbackPreallocateOutputsEnabled();
+void setVmapFallbackPreallocateOutputsEnabled(bool enabled);
+
+// When enabled, the fallback first consults the runtime decomposition
+// registry and rewrites the op in terms of batch-rule-covered primitives
+// instead of entering the per-slice loop; one batched call beats batch_size
+// sequential ones by orders of magnitude. Off by default while the registry
+// is small. See NOTE: [Runtime decomposition registry] in Decompositions.h.
+bool isVmapFallbackDecomposeEnabled();
+void setVmapFallbackDecomposeEnabled(bool enabled);
+
+// When enabled and the outputs live on CUDA, the sliced fallback
+// round-robins slice execution over a small pool of side streams, with
+// events ordering the slab writes against the current stream: the slices
+// are independent, so their index computation, kernels, and output copies
+// overlap instead of serializing on one stream. Implies the preallocated
+// output slabs (the streams write into them at disjoint indices). See
+// NOTE: [Streamed CUDA fallback].
+bool isVmapFallbackStreamsEnabled();
+void setVmapFallbackStreamsEnabled(bool enabled);
+
+// Always-on profiling of the sliced fallback, keyed by operator name.
+// warnFallback only tells you an op hit the fallback once; these counters
+// tell you how often, how long, and at what batch sizes, which is what we
+// use to prioritize which batch rules to write next (the dynamic analogue
+// of op_analysis/).
+struct VmapFallbackOpStats {
+  int64_t num_calls = 0;      // number of times the sliced fallback ran
+  int64_t total_ns = 0;       // wall time spent inside the fallback
+  int64_t total_batches = 0;  // sum of slice counts across calls
+  int64_t max_batch_size = 0; // largest slice count seen in one call
+};
+TORCH_API std::unordered_map<std::string, VmapFallbackOpStats> getVmapFallbackStats();
+TORCH_API void resetVmapFallbackStats();
+
 template <typename A> A vector_to_result(const std::vector<IValue>& buffer) {
   return buffer[0].to<A>();
 }
@@ -66,6 +112,35 @@ std::tuple<A, B, C> slow_fallback(const c10::OperatorHandle& op, ArrayRef<IValue
   return vector_to_result<A, B, C>(stack);
 }
 
+// The boxed fallback that runs at the dynamic layer front mode key.
+// Defined in DynamicLayer.cpp; declared here so generated unboxed fast
+// paths can bail out into it when their preconditions don't hold.
+void dynamicLayerFrontFallback(const c10::OperatorHandle& op, torch::jit::Stack* stack);
+
+// Like slow_fallback, but re-enters the full boxed dynamic layer machinery
+// instead of the sliced vmap fallback. Generated *_front_fastpath functions
+// call this for stacks they don't handle (nested transforms, grad wrappers).
+template <typename Ret>
+Ret front_fallback(const c10::OperatorHandle& op, ArrayRef<IValue> args) {
+  std::vector<IValue> stack(args.begin(), args.end());
+  dynamicLayerFrontFallback(op, &stack);
+  return vector_to_result<Ret>(stack);
+}
+
+template <typename A, typename B>
+std::tuple<A, B> front_fallback(const c10::OperatorHandle& op, ArrayRef<IValue> args) {
+  std::vector<IValue> stack(args.begin(), args.end());
+  dynamicLayerFrontFallback(op, &stack);
+  return vector_to_result<A, B>(stack);
+}
+
+template <typename A, typename B, typename C>
+std::tuple<A, B, C> front_fallback(const c10::OperatorHandle& op, ArrayRef<IValue> args) {
+  std::vector<IValue> stack(args.begin(), args.end());
+  dynamicLayerFrontFallback(op, &stack);
+  return vector_to_result<A, B, C>(stack);
+}
+
 
 }
 } // namespace at
@@ -15,6 +15,13 @@
 #include <torch/csrc/jit/python/pybind_utils.h>
 #include <torch/csrc/jit/tensorexpr/codegen.h>
 #include <torch/csrc/utils/pybind.h>
+#include <c10/util/SmallVector.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
 
 using namespace torch::jit::tensorexpr;
 
@@ -43,7 +50,28 @@ static uint8_t packFlags(const LocalState &state, const at::Tensor &v) {
          (static_cast<uint8_t>(dtype) << 1);
 }
 
-using hash_key_t = std::vector<int64_t>;
+/// Inline capacity of a specialization key. Typical keys are a handful of
+/// values per tensor argument plus one per dim, so this keeps key
+/// construction allocation-free for realistic argument lists.
+constexpr size_t kCompileCacheKeyInlineSize = 64;
+
+/// A specialization key that accumulates its hash while it is being built,
+/// so lookup never re-walks the key. Fixed inline capacity; falls back to
+/// the heap only for unusually long keys.
+struct hash_key_t {
+  c10::SmallVector<int64_t, kCompileCacheKeyInlineSize> values;
+  std::size_t hash = 0;
+
+  void push(int64_t v) {
+    values.push_back(v);
+    hash ^= v + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  }
+
+  bool operator==(const hash_key_t &other) const {
+    return hash == other.hash && values == other.values;
+  }
+};
+
 /// Per-tensor cache specialization key targetting dynamic shapes. Records
 /// dtype, dispatch options, aliasing, and per-dim contiguity/broadcasting
 /// information.
@@ -82,12 +110,15 @@ enum HasherFlags {
   NONE_HASH,
   STATIC_HASH,
   DYNAMIC_HASH,
+  BUCKETED_HASH,
 };
 
-std::vector<int> genDimFlags(c10::IntArrayRef sizes, c10::IntArrayRef strides) {
-  // Pack all the properties for each dimension into a uint8.
+void genDimFlags(c10::IntArrayRef sizes, c10::IntArrayRef strides,
+                 hash_key_t &key) {
+  // Pack all the properties for each dimension into a uint8, appended
+  // directly onto the key.
   int nDims = sizes.size();
-  std::vector<int> dimflags(nDims);
+  uint8_t prev_flag = 0;
   for (int64_t dim = 0; dim < nDims; ++dim) {
     uint8_t flag =
         (sizes[dim] == 0 ? SIZE_MISSING
@@ -100,34 +131,165 @@ std::vector<int> genDimFlags(c10::IntArrayRef sizes, c10::IntArrayRef strides) {
                strides[dim] == strides[dim + 1] * sizes[dim + 1]) {
       flag |= STRIDE_CONTIGUOUS;
     } else if (dim > 0 && strides[dim] == strides[dim - 1] * sizes[dim - 1] &&
-               (dimflags[dim - 1] & STRIDE_CONTIGUOUS) == 0) {
+               (prev_flag & STRIDE_CONTIGUOUS) == 0) {
       flag |= STRIDE_TRANSPOSED_CONTIGUOUS;
     } else {
       flag |= STRIDE_AS_ARG;
     }
-    dimflags[dim] = flag;
+    key.push(flag);
+    prev_flag = flag;
   }
-  return dimflags;
 }
 
-hash_key_t dynamic_hasher(const LocalState &state, const at::Tensor &v) {
-  hash_key_t hash = {DYNAMIC_HASH, static_cast<int>(packFlags(state, v)),
-                     static_cast<int>(state.apply(v.key_set()).raw_repr()),
-                     static_cast<int>(v.ndimension())};
-  auto dimFlags = genDimFlags(v.sizes(), v.strides());
-  hash.insert(hash.end(), dimFlags.begin(), dimFlags.end());
-  return hash;
+void dynamic_hasher(const LocalState &state, const at::Tensor &v,
+                    hash_key_t &key) {
+  key.push(DYNAMIC_HASH);
+  key.push(packFlags(state, v));
+  key.push(static_cast<int>(state.apply(v.key_set()).raw_repr()));
+  key.push(v.ndimension());
+  genDimFlags(v.sizes(), v.strides(), key);
 }
 
 /// Per-tensor cache specialization key targetting static shapes. Recordsdtype,
 /// dispatch options, aliasing, and full shapes and strides.
-hash_key_t static_hasher(const LocalState &state, const at::Tensor &v) {
-  hash_key_t hash = {STATIC_HASH, static_cast<int>(packFlags(state, v)),
-                     static_cast<int>(state.apply(v.key_set()).raw_repr()),
-                     static_cast<int>(v.ndimension())};
-  hash.insert(hash.end(), v.sizes().begin(), v.sizes().end());
-  hash.insert(hash.end(), v.strides().begin(), v.strides().end());
-  return hash;
+void static_hasher(const LocalState &state, const at::Tensor &v,
+                   hash_key_t &key) {
+  key.push(STATIC_HASH);
+  key.push(packFlags(state, v));
+  key.push(static_cast<int>(state.apply(v.key_set()).raw_repr()));
+  key.push(v.ndimension());
+  for (auto size : v.sizes()) {
+    key.push(size);
+  }
+  for (auto stride : v.strides()) {
+    key.push(stride);
+  }
+}
+
+// NOTE: [Shape-bucketed cache keys]
+// static_hasher recompiles per exact shape and dynamic_hasher still
+// fragments the key by stride layout, which is a poor fit for
+// variable-length batch serving where inputs are padded to a handful of
+// canonical lengths. bucketed_hasher keys each dim on the bucket its size
+// falls into (configurable boundaries; past the last boundary, the next
+// power of two), specializes strides only on broadcasting (stride 0), and
+// leaves everything else to be read off the inputs at call time. One
+// compiled kernel therefore serves an entire bucket with no recompiles
+// inside it -- the contract is that a kernel compiled under
+// "BucketedShapeHasher" must treat sizes and strides as runtime arguments
+// taken from its input tensors, not bake them in.
+
+/// Bucket boundaries, sorted ascending. Swapped atomically so concurrent
+/// cache lookups never see a partially-updated list.
+std::shared_ptr<const std::vector<int64_t>> &shapeBucketBoundariesStorage() {
+  static std::shared_ptr<const std::vector<int64_t>> boundaries =
+      std::make_shared<const std::vector<int64_t>>();
+  return boundaries;
+}
+
+void setShapeBucketBoundaries(std::vector<int64_t> boundaries) {
+  for (size_t i = 0; i < boundaries.size(); ++i) {
+    TORCH_CHECK(boundaries[i] >= 1, "shape bucket boundaries must be >= 1, got ",
+                boundaries[i]);
+    TORCH_CHECK(i == 0 || boundaries[i - 1] < boundaries[i],
+                "shape bucket boundaries must be strictly increasing");
+  }
+  std::atomic_store(
+      &shapeBucketBoundariesStorage(),
+      std::shared_ptr<const std::vector<int64_t>>(
+          std::make_shared<const std::vector<int64_t>>(std::move(boundaries))));
+}
+
+std::vector<int64_t> getShapeBucketBoundaries() {
+  return *std::atomic_load(&shapeBucketBoundariesStorage());
+}
+
+/// Returns the bucket's upper bound: the smallest configured boundary >=
+/// size, or the next power of two once past (or without) configured
+/// boundaries. Using the bound itself as the key value keeps buckets stable
+/// when boundaries are appended.
+int64_t bucketForSize(const std::vector<int64_t> &boundaries, int64_t size) {
+  auto it = std::lower_bound(boundaries.begin(), boundaries.end(), size);
+  if (it != boundaries.end()) {
+    return *it;
+  }
+  int64_t bound = 1;
+  while (bound < size) {
+    bound <<= 1;
+  }
+  return bound;
+}
+
+/// Per-tensor cache specialization key targetting bucketed dynamic shapes.
+/// See NOTE: [Shape-bucketed cache keys].
+void bucketed_hasher(const LocalState &state, const at::Tensor &v,
+                     const std::vector<int64_t> &boundaries,
+                     hash_key_t &key) {
+  key.push(BUCKETED_HASH);
+  key.push(packFlags(state, v));
+  key.push(static_cast<int>(state.apply(v.key_set()).raw_repr()));
+  key.push(v.ndimension());
+  auto sizes = v.sizes();
+  auto strides = v.strides();
+  for (int64_t dim = 0; dim < v.ndimension(); ++dim) {
+    // Broadcasting (size one/missing, stride zero) changes the kernel, so
+    // it stays in the key; exact strides would fragment the bucket, so any
+    // other layout is uniformly "stride is a runtime arg".
+    uint8_t flag =
+        (sizes[dim] == 0 ? SIZE_MISSING
+                         : (sizes[dim] == 1 ? SIZE_ONE : SIZE_OTHER));
+    flag |= (strides[dim] == 0 ? STRIDE_ZERO : STRIDE_AS_ARG);
+    key.push(flag);
+    if (flag & SIZE_OTHER) {
+      key.push(bucketForSize(boundaries, sizes[dim]));
+    }
+  }
+}
+
+/// On-disk cache file framing, see NOTE: [Persistent compile cache].
+constexpr const char *kCompileCacheFileMagic = "functorch-compile-cache-v1";
+
+void writeUint64(std::ofstream &out, uint64_t v) {
+  out.write(reinterpret_cast<const char *>(&v), sizeof(v));
+}
+
+uint64_t readUint64(std::ifstream &in) {
+  uint64_t v = 0;
+  in.read(reinterpret_cast<char *>(&v), sizeof(v));
+  return v;
+}
+
+void writeString(std::ofstream &out, const std::string &s) {
+  writeUint64(out, s.size());
+  out.write(s.data(), s.size());
+}
+
+std::string readString(std::ifstream &in) {
+  std::string s(readUint64(in), '\0');
+  in.read(&s[0], s.size());
+  return s;
+}
+
+/// Fingerprint a cache file is validated against: a persisted kernel is
+/// only trusted when it was produced by the same torch build.
+std::string cacheFingerprint() {
+  return py::cast<std::string>(
+      py::str(py::module::import("torch").attr("__version__")));
+}
+
+/// Resolve the Python-facing hasher name to an enum once per cache call,
+/// rather than string-comparing per tensor argument.
+HasherFlags parseHasherType(const std::string &hasherType) {
+  if (hasherType == "StaticShapeHasher") {
+    return STATIC_HASH;
+  }
+  if (hasherType == "DynamicShapeHasher") {
+    return DYNAMIC_HASH;
+  }
+  if (hasherType == "BucketedShapeHasher") {
+    return BUCKETED_HASH;
+  }
+  TORCH_CHECK(false, "Unknown hasherType: ", hasherType);
 }
 
 /// ArgCompileCache is a templated class allowing plugging of different types of
@@ -142,52 +304,82 @@ public:
   /// Cache type mapping specialization keys to compiled kernels.
   class vector_hasher {
   public:
-    std::size_t operator()(hash_key_t const &vec) const {
-      std::size_t seed = vec.size();
-      for (auto &i : vec) {
-        seed ^= i + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-      }
-      return seed;
+    std::size_t operator()(hash_key_t const &key) const {
+      // The hash was accumulated while the key was built.
+      return key.hash;
     }
   };
-  using Cache = std::unordered_map<hash_key_t, py::object, vector_hasher>;
+
+  /// A compiled artifact plus its CLOCK second-chance bit, see
+  /// NOTE: [Compile cache eviction]. The bit is set on every hit, which
+  /// happens under the shared lock, hence the atomic.
+  struct CacheEntry {
+    py::object fn;
+    mutable std::atomic<bool> referenced{true};
+
+    explicit CacheEntry(py::object f) : fn(std::move(f)) {}
+    CacheEntry(CacheEntry &&other) noexcept
+        : fn(std::move(other.fn)),
+          referenced(other.referenced.load(std::memory_order_relaxed)) {}
+  };
+  using Cache = std::unordered_map<hash_key_t, CacheEntry, vector_hasher>;
+
+  /// Non-tensor (static) args, extracted from the Python tuple up front so
+  /// the rest of the key computation doesn't need the interpreter.
+  using extra_args_t = c10::SmallVector<int64_t, 8>;
 
   /// Compute the set of specialization keys based on the inputs to
   /// the kernel.
-  hash_key_t computeCacheKey(PyObject *args,
+  hash_key_t computeCacheKey(const extra_args_t &extraArgs,
                              const std::vector<at::Tensor> &tensorArgs,
-                             int numTensorArgs, const std::string &hasherType,
+                             int numTensorArgs, HasherFlags hasherType,
                              int64_t id, int64_t fw_compiler_id,
                              int64_t bw_compiler_id) {
     LocalState state;
     hash_key_t cacheKey;
+    // Snapshot the boundaries once per call so every tensor arg buckets
+    // against the same list.
+    std::shared_ptr<const std::vector<int64_t>> bucketBoundaries;
+    if (hasherType == BUCKETED_HASH) {
+      bucketBoundaries = std::atomic_load(&shapeBucketBoundariesStorage());
+    }
     for (int i = 0; i < numTensorArgs; ++i) {
       if (tensorArgs[i].defined()) {
         // Only hash the tensor when its defined.
-        if (hasherType == "StaticShapeHasher") {
-          auto res = static_hasher(state, tensorArgs[i]);
-          cacheKey.insert(cacheKey.end(), res.begin(), res.end());
-        } else if (hasherType == "DynamicShapeHasher") {
-          auto res = dynamic_hasher(state, tensorArgs[i]);
-          cacheKey.insert(cacheKey.end(), res.begin(), res.end());
+        if (hasherType == STATIC_HASH) {
+          static_hasher(state, tensorArgs[i], cacheKey);
+        } else if (hasherType == DYNAMIC_HASH) {
+          dynamic_hasher(state, tensorArgs[i], cacheKey);
+        } else if (hasherType == BUCKETED_HASH) {
+          bucketed_hasher(state, tensorArgs[i], *bucketBoundaries, cacheKey);
         }
       } else {
         // Add a value to the cacheKey to indicate a None tensor.
-        cacheKey.push_back(NONE_HASH);
+        cacheKey.push(NONE_HASH);
       }
     }
-    cacheKey.push_back(id);
-    cacheKey.push_back(fw_compiler_id);
-    cacheKey.push_back(bw_compiler_id);
-    cacheKey.push_back(numTensorArgs);
+    cacheKey.push(id);
+    cacheKey.push(fw_compiler_id);
+    cacheKey.push(bw_compiler_id);
+    cacheKey.push(numTensorArgs);
 
     // Cache the non-tensor args. Currently, all the non-tensor args are cached.
+    for (auto extraArg : extraArgs) {
+      cacheKey.push(extraArg);
+    }
+    return cacheKey;
+  }
+
+  /// Pull the non-tensor args out of the Python tuple. Must be called with
+  /// the GIL held; everything downstream of it is GIL-free.
+  extra_args_t parseExtraArgs(int numTensorArgs, PyObject *args) {
+    extra_args_t result;
     for (int i = numTensorArgs; i < PyTuple_Size(args); i++) {
       PyObject *arg = PyTuple_GET_ITEM(args, i);
       assert(PyLong_Check(arg));
-      cacheKey.push_back(PyLong_AsLong(arg));
+      result.push_back(PyLong_AsLong(arg));
     }
-    return cacheKey;
+    return result;
   }
 
   std::vector<at::Tensor> parsePythonArgs(int numTensorArgs, PyObject *args) {
@@ -215,21 +407,115 @@ public:
     return tensorArgs;
   }
 
+  /// NOTE: [Persistent compile cache]
+  /// save() pickles every picklable compiled artifact together with its
+  /// specialization key and a torch-version fingerprint; load() validates
+  /// the fingerprint and parks the raw pickle bytes in pending_ without
+  /// touching the interpreter. An entry is only unpickled on its first
+  /// hit, so a warm start pays for exactly the kernels it actually uses.
+  /// Persistence is only useful when the Python side feeds stable ids
+  /// into the key; aot_function derives them from the callables' qualified
+  /// names and source text (see NOTE: [Stable cache ids] in
+  /// aot_autograd.py), falling back to per-process id() only when the
+  /// source is unavailable.
+
+  /// NOTE: [Compile cache eviction]
+  /// With DynamicShapeHasher and variable input shapes the cache grows
+  /// without bound, so long-running services can opt into a max-entries
+  /// policy (set_max_size). Eviction is CLOCK/second-chance rather than
+  /// strict LRU because hits only hold the shared lock (see NOTE:
+  /// [GIL-free CompileCache reads]): a hit flips an atomic bit instead of
+  /// reordering a list. When an insert would exceed the bound, a first
+  /// sweep spares entries hit since the last sweep (clearing their bit)
+  /// and a second sweep evicts regardless.
+
   /// Check if the function has already been compiled.
+  ///
+  /// NOTE: [GIL-free CompileCache reads]
+  /// Hits on already-compiled keys are the steady state in multi-threaded
+  /// serving, so the key computation and the map probe run with the GIL
+  /// released, under a reader lock. Only the final handle copy (a refcount
+  /// bump) reacquires the GIL. Lock ordering is mutex-then-GIL everywhere:
+  /// no code path waits on mutex_ while holding the GIL, so reacquiring
+  /// the GIL under the reader lock cannot deadlock, and copying the handle
+  /// under the lock keeps clear() from destroying it underneath us.
   py::object at(int64_t id, int64_t fw_compiler_id, int64_t bw_compiler_id,
                 int numTensorArgs, const std::string &hasherType,
                 PyObject *args) {
+    // Everything that touches the interpreter happens up front.
     std::vector<at::Tensor> tensorArgs = parsePythonArgs(numTensorArgs, args);
-    hash_key_t cacheKey =
-        computeCacheKey(args, tensorArgs, numTensorArgs, hasherType, id,
-                        fw_compiler_id, bw_compiler_id);
+    extra_args_t extraArgs = parseExtraArgs(numTensorArgs, args);
+    HasherFlags hasher = parseHasherType(hasherType);
+    py::object result = py::none();
+    hash_key_t cacheKey;
+    std::string pendingBlob;
+    bool havePending = false;
+    {
+      py::gil_scoped_release release;
+      cacheKey =
+          computeCacheKey(extraArgs, tensorArgs, numTensorArgs, hasher, id,
+                          fw_compiler_id, bw_compiler_id);
+      std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+      auto item = cache_.find(cacheKey);
+      if (C10_LIKELY(item != cache_.end())) {
+        item->second.referenced.store(true, std::memory_order_relaxed);
+        py::gil_scoped_acquire acquire;
+        result = item->second.fn;
+      } else {
+        auto pending = pending_.find(cacheKey);
+        if (pending != pending_.end()) {
+          pendingBlob = pending->second;
+          havePending = true;
+        }
+      }
+    }
+    if (C10_UNLIKELY(havePending)) {
+      result = materializePending(std::move(cacheKey), pendingBlob);
+    }
+    return result;
+  }
 
-    auto item = cache_.find(cacheKey); // protected by GIL
+  /// Unpickle a persisted entry on its first hit and promote it from
+  /// pending_ into the in-memory map.
+  py::object materializePending(hash_key_t cacheKey, const std::string &blob) {
+    py::object result =
+        py::module::import("pickle").attr("loads")(py::bytes(blob));
+    // Second handle for the map; if we lose the insertion race it is
+    // destroyed only after the GIL is back (declaration order).
+    py::object forMap = result;
+    std::vector<py::object> evicted;
+    {
+      py::gil_scoped_release release;
+      std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+      pending_.erase(cacheKey);
+      if (cache_.find(cacheKey) == cache_.end()) {
+        if (maxSize_ > 0) {
+          evictDownToLocked(maxSize_ - 1, evicted);
+        }
+        cache_.emplace(std::move(cacheKey), CacheEntry(std::move(forMap)));
+      }
+    }
+    return result;
+  }
 
-    if (C10_LIKELY(item != cache_.end())) {
-      return item->second;
+  /// Evict entries until at most `limit` remain. Must be called with the
+  /// exclusive lock held and the GIL released; evicted handles are moved
+  /// into `evicted` so the caller destroys them once the GIL is back.
+  void evictDownToLocked(size_t limit, std::vector<py::object> &evicted) {
+    for (int pass = 0; pass < 2 && cache_.size() > limit; ++pass) {
+      for (auto it = cache_.begin();
+           it != cache_.end() && cache_.size() > limit;) {
+        if (pass == 0 &&
+            it->second.referenced.load(std::memory_order_relaxed)) {
+          it->second.referenced.store(false, std::memory_order_relaxed);
+          ++it;
+        } else {
+          evicted.push_back(std::move(it->second.fn));
+          it = cache_.erase(it);
+          ++numEvictions_;
+        }
+      }
     }
-    return py::none();
   }
 
   /// Insert a new compiled functions for new tensor properties.
@@ -237,21 +523,175 @@ public:
               int numTensorArgs, const std::string &hasherType,
               const py::object &compileFn, PyObject *args) {
     std::vector<at::Tensor> tensorArgs = parsePythonArgs(numTensorArgs, args);
-    LocalState state;
+    extra_args_t extraArgs = parseExtraArgs(numTensorArgs, args);
+    HasherFlags hasher = parseHasherType(hasherType);
+    // Take our own handle while we still hold the GIL; it is either moved
+    // into the map (no refcount traffic) or, if the key lost a race with
+    // another inserter, destroyed only after the GIL is reacquired below.
+    py::object fn = compileFn;
+    std::vector<py::object> evicted;
+    py::gil_scoped_release release;
     hash_key_t cacheKey =
-        computeCacheKey(args, tensorArgs, numTensorArgs, hasherType, id,
+        computeCacheKey(extraArgs, tensorArgs, numTensorArgs, hasher, id,
                         fw_compiler_id, bw_compiler_id);
-    cache_.emplace(cacheKey, compileFn);
+    std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+    if (cache_.find(cacheKey) != cache_.end()) {
+      // Lost the race with another inserter; keep the first entry. Our
+      // handle is destroyed only after the GIL is reacquired (declaration
+      // order), never inside emplace with the GIL released.
+      return;
+    }
+    if (maxSize_ > 0) {
+      evictDownToLocked(maxSize_ - 1, evicted);
+    }
+    cache_.emplace(std::move(cacheKey), CacheEntry(std::move(fn)));
+  }
+
+  /// Bound the cache to `maxSize` entries (<= 0 means unbounded),
+  /// evicting immediately if it is already over the new bound.
+  void setMaxSize(int64_t maxSize) {
+    std::vector<py::object> evicted;
+    py::gil_scoped_release release;
+    std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+    maxSize_ = maxSize;
+    if (maxSize_ > 0) {
+      evictDownToLocked(maxSize_, evicted);
+    }
+  }
+
+  // The accessors below drop the GIL before taking the lock: lock ordering
+  // is mutex-then-GIL everywhere (see NOTE: [GIL-free CompileCache reads]),
+  // so waiting on mutex_ with the GIL held could deadlock against a reader
+  // that holds the lock and wants the GIL, with a writer queued between.
+  int64_t maxSize() const {
+    py::gil_scoped_release release;
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    return maxSize_;
   }
 
-  const int64_t size() const { return cache_.size(); }
+  int64_t numEvictions() const {
+    py::gil_scoped_release release;
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    return numEvictions_;
+  }
+
+  const int64_t size() const {
+    py::gil_scoped_release release;
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    return cache_.size();
+  }
+
+  /// Persist the cache to `path`. Entries whose artifacts don't pickle
+  /// (e.g. callables closing over C handles) are skipped; they simply
+  /// recompile in the next process. Returns the number of entries written.
+  int64_t save(const std::string &path) {
+    // Snapshot under the reader lock; handle copies reacquire the GIL
+    // inside the lock, per NOTE: [GIL-free CompileCache reads].
+    std::vector<std::pair<hash_key_t, py::object>> entries;
+    std::vector<std::pair<hash_key_t, std::string>> blobs;
+    {
+      py::gil_scoped_release release;
+      std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+      for (const auto &item : pending_) {
+        // Never-hit persisted entries round-trip without deserializing.
+        blobs.emplace_back(item.first, item.second);
+      }
+      py::gil_scoped_acquire acquire;
+      for (const auto &item : cache_) {
+        entries.emplace_back(item.first, item.second.fn);
+      }
+    }
+    py::object dumps = py::module::import("pickle").attr("dumps");
+    for (const auto &entry : entries) {
+      try {
+        py::bytes blob = dumps(entry.second);
+        blobs.emplace_back(entry.first, static_cast<std::string>(blob));
+      } catch (const py::error_already_set &) {
+        continue;
+      }
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    TORCH_CHECK(out.is_open(), "CompileCache.save: could not open ", path);
+    writeString(out, kCompileCacheFileMagic);
+    writeString(out, cacheFingerprint());
+    writeUint64(out, blobs.size());
+    for (const auto &blob : blobs) {
+      writeUint64(out, blob.first.values.size());
+      for (auto v : blob.first.values) {
+        writeUint64(out, static_cast<uint64_t>(v));
+      }
+      writeString(out, blob.second);
+    }
+    TORCH_CHECK(out.good(), "CompileCache.save: error writing ", path);
+    return blobs.size();
+  }
+
+  /// Load persisted entries from `path` into pending_ without unpickling
+  /// anything; see NOTE: [Persistent compile cache]. Returns the number of
+  /// entries made available, or 0 when the file is missing or was written
+  /// by a different torch build.
+  int64_t load(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+      return 0;
+    }
+    if (readString(in) != kCompileCacheFileMagic ||
+        readString(in) != cacheFingerprint()) {
+      return 0;
+    }
+    uint64_t numEntries = readUint64(in);
+    std::vector<std::pair<hash_key_t, std::string>> blobs;
+    blobs.reserve(numEntries);
+    for (uint64_t i = 0; i < numEntries; ++i) {
+      hash_key_t key;
+      uint64_t numValues = readUint64(in);
+      for (uint64_t j = 0; j < numValues; ++j) {
+        // Rebuild through push() so the accumulated hash is recomputed
+        // rather than trusted from disk.
+        key.push(static_cast<int64_t>(readUint64(in)));
+      }
+      blobs.emplace_back(std::move(key), readString(in));
+      TORCH_CHECK(!in.fail(), "CompileCache.load: truncated cache file ", path);
+    }
+    int64_t loaded = 0;
+    py::gil_scoped_release release;
+    std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+    for (auto &blob : blobs) {
+      if (cache_.count(blob.first) != 0 || pending_.count(blob.first) != 0) {
+        continue;
+      }
+      pending_.emplace(std::move(blob.first), std::move(blob.second));
+      ++loaded;
+    }
+    return loaded;
+  }
 
   /// Clear the cache.
-  void clear() { cache_.clear(); }
+  void clear() {
+    // Swap the entries out under the write lock (GIL released, see NOTE:
+    // [GIL-free CompileCache reads] for the lock ordering), then destroy
+    // the Python handles after the GIL is back.
+    Cache dead;
+    {
+      py::gil_scoped_release release;
+      std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+      dead.swap(cache_);
+      pending_.clear();
+    }
+  }
 
 private:
-  /// Compilation cache holding key and the compiled function.
+  /// Compilation cache holding key and the compiled function. Guarded by
+  /// mutex_; reads take a shared lock, writes an exclusive one.
   Cache cache_;
+  /// Persisted-but-not-yet-unpickled entries, keyed like cache_ and
+  /// guarded by the same mutex_. See NOTE: [Persistent compile cache].
+  std::unordered_map<hash_key_t, std::string, vector_hasher> pending_;
+  /// Entry bound (<= 0 means unbounded) and lifetime eviction count, both
+  /// guarded by mutex_. See NOTE: [Compile cache eviction].
+  int64_t maxSize_ = 0;
+  int64_t numEvictions_ = 0;
+  mutable std::shared_timed_mutex mutex_;
 };
 
 static CompileCache *createCompileCache() { return new CompileCache(); }
@@ -281,7 +721,28 @@ void initCompileCacheBindings(PyObject *module) {
                          hasherType, compileFn, args.ptr());
            })
       .def("clear", [](CompileCache &self) { self.clear(); })
-      .def("size", [](CompileCache &self) { return self.size(); });
+      .def("size", [](CompileCache &self) { return self.size(); })
+      .def("save",
+           [](CompileCache &self, const std::string &path) {
+             return self.save(path);
+           })
+      .def("load",
+           [](CompileCache &self, const std::string &path) {
+             return self.load(path);
+           })
+      .def("set_max_size",
+           [](CompileCache &self, int64_t maxSize) {
+             self.setMaxSize(maxSize);
+           })
+      .def("max_size", [](CompileCache &self) { return self.maxSize(); })
+      .def("num_evictions",
+           [](CompileCache &self) { return self.numEvictions(); });
+  // See NOTE: [Shape-bucketed cache keys]. Process-wide, since the buckets
+  // describe the serving workload, not one cache instance.
+  auto m = py::reinterpret_borrow<py::module>(te);
+  m.def("_compile_cache_set_shape_bucket_boundaries",
+        &setShapeBucketBoundaries);
+  m.def("_compile_cache_shape_bucket_boundaries", &getShapeBucketBoundaries);
 }
 
 } // namespace functorch
@@ -0,0 +1,92 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <functorch/csrc/Decompositions.h>
+
+#include <ATen/ATen.h>
+#include <c10/util/irange.h>
+
+#include <cmath>
+#include <unordered_map>
+
+namespace at {
+namespace functorch {
+
+namespace {
+
+// See NOTE: [Runtime decomposition registry]. Entries are boxed so the
+// registry can be consulted from the boxed fallback without unboxing; each
+// one pops its own arguments and pushes its returns, like any boxed kernel.
+using DecompositionFn = void (*)(const c10::OperatorHandle&, torch::jit::Stack*);
+
+// copysign promotes integral (and bool) inputs to the default floating dtype.
+ScalarType copysignResultType(ScalarType common) {
+  if (c10::isIntegralType(common, /*includeBool=*/true)) {
+    return c10::typeMetaToScalarType(at::get_default_dtype());
+  }
+  return common;
+}
+
+Tensor copysign_tensor_decomp(const Tensor& self, const Tensor& other) {
+  const auto common = copysignResultType(at::result_type(self, other));
+  auto magnitude = at::abs(self.to(common));
+  // signbit (rather than a comparison with zero) so that -0.0 flips the sign,
+  // matching copysign's IEEE semantics.
+  return at::where(at::signbit(other.to(common)), -magnitude, magnitude);
+}
+
+void copysign_tensor_boxed(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
+  auto other = torch::jit::pop(*stack).toTensor();
+  auto self = torch::jit::pop(*stack).toTensor();
+  torch::jit::push(*stack, copysign_tensor_decomp(self, other));
+}
+
+void copysign_scalar_boxed(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
+  auto other = torch::jit::pop(*stack).toScalar();
+  auto self = torch::jit::pop(*stack).toTensor();
+  const auto common = copysignResultType(at::result_type(self, other));
+  auto magnitude = at::abs(self.to(common));
+  const bool negative = std::signbit(other.toDouble());
+  torch::jit::push(*stack, negative ? at::neg(magnitude) : magnitude);
+}
+
+const std::unordered_map<c10::OperatorName, DecompositionFn>& decompositionRegistry() {
+  static const std::unordered_map<c10::OperatorName, DecompositionFn> registry = [] {
+    std::unordered_map<c10::OperatorName, DecompositionFn> result;
+    result.emplace(c10::OperatorName("aten::copysign", "Tensor"), &copysign_tensor_boxed);
+    result.emplace(c10::OperatorName("aten::copysign", "Scalar"), &copysign_scalar_boxed);
+    return result;
+  }();
+  return registry;
+}
+
+} // namespace
+
+bool runDecomposition(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
+  const auto& registry = decompositionRegistry();
+  auto it = registry.find(op.schema().operator_name());
+  if (it == registry.end()) {
+    return false;
+  }
+  it->second(op, stack);
+  return true;
+}
+
+bool hasDecomposition(const c10::OperatorName& name) {
+  return decompositionRegistry().count(name) > 0;
+}
+
+std::vector<std::string> decompositionRegistryOps() {
+  std::vector<std::string> result;
+  result.reserve(decompositionRegistry().size());
+  for (const auto& entry : decompositionRegistry()) {
+    result.push_back(c10::toString(entry.first));
+  }
+  return result;
+}
+
+}
+} // namespace at
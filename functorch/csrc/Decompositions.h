@@ -0,0 +1,46 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree.
+
+#pragma once
+
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <torch/library.h>
+
+#include <string>
+#include <vector>
+
+namespace at {
+namespace functorch {
+
+// NOTE: [Runtime decomposition registry]
+//
+// BatchRulesDecompositions.cpp can only decompose ops that have a
+// CompositeImplicitAutograd kernel to forward to; ops with real backend
+// kernels and no batch rule fall through to the per-slice for-loop fallback,
+// and the Python table in functorch/_src/decompositions.py only helps code
+// that goes through the tracer. This registry holds hand-written C++
+// decompositions (in terms of ops that do have batch rules) for such ops.
+// Two consumers:
+// - the vmap fallback decomposes instead of slicing when
+//   isVmapFallbackDecomposeEnabled() is set (see BatchedFallback.cpp);
+// - the AOT tracer reaches the same table through
+//   functorch._C._run_native_decomposition, so the traced graph contains
+//   the decomposed primitives (see functorch/_src/decompositions.py).
+// Because the decompositions re-enter the dispatcher, they compose with
+// nested vmap and grad transforms for free.
+
+// Runs the registered decomposition for `op` on `stack`, if there is one.
+// Returns false (and leaves the stack untouched) when `op` isn't registered.
+TORCH_API bool runDecomposition(const c10::OperatorHandle& op, torch::jit::Stack* stack);
+
+// Whether `name` has a registered decomposition.
+TORCH_API bool hasDecomposition(const c10::OperatorName& name);
+
+// The registered operators, as "aten::op.overload" strings.
+TORCH_API std::vector<std::string> decompositionRegistryOps();
+
+}
+} // namespace at
@@ -0,0 +1,149 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <functorch/csrc/DispatchBenchmark.h>
+
+#include <ATen/ATen.h>
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <c10/util/irange.h>
+#include <functorch/csrc/BatchedFallback.h>
+#include <functorch/csrc/Constants.h>
+#include <functorch/csrc/DynamicLayer.h>
+#include <functorch/csrc/PlumbingHelper.h>
+#include <functorch/csrc/TensorWrapper.h>
+
+#include <chrono>
+
+namespace at {
+namespace functorch {
+
+namespace {
+
+template <typename Fn>
+double nsPerIter(int64_t iters, Fn fn) {
+  const int64_t warmup = std::max<int64_t>(iters / 10, 10);
+  for (const auto i : c10::irange(warmup)) {
+    (void)i;
+    fn();
+  }
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto i : c10::irange(iters)) {
+    (void)i;
+    fn();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  return ns / static_cast<double>(iters);
+}
+
+double benchLayerPushPop(int64_t iters) {
+  return nsPerIter(iters, [] {
+    initAndPushDynamicLayer(kBatchedKey, 2, RandomnessType::Error);
+    popDynamicLayerAndDeleteMetadata();
+  });
+}
+
+// at::add on a tensor batched at `depth` nested vmap levels: front fallback,
+// generated plumbing once per level, then the real add.
+double benchVmappedAdd(int64_t iters, int64_t depth) {
+  std::vector<int64_t> sizes(depth, 2);
+  sizes.push_back(4);
+  Tensor batched = at::ones(sizes);
+
+  std::vector<int64_t> levels;
+  for (const auto i : c10::irange(depth)) {
+    (void)i;
+    levels.push_back(
+        initAndPushDynamicLayer(kBatchedKey, 2, RandomnessType::Error));
+  }
+  for (const auto level : levels) {
+    batched = makeBatched(batched, 0, level);
+  }
+
+  const auto ns = nsPerIter(iters, [&] {
+    auto out = at::add(batched, batched);
+  });
+
+  // Drop the BatchedTensors before deleting the levels they point at.
+  batched = Tensor();
+  for (const auto i : c10::irange(depth)) {
+    (void)i;
+    popDynamicLayerAndDeleteMetadata();
+  }
+  return ns;
+}
+
+// at::add on a TensorWrapper under a single grad layer: front fallback,
+// materializeGradWrappers, autograd pass-through, unwrap.
+double benchGradWrappedAdd(int64_t iters) {
+  const auto level = initAndPushDynamicLayer(
+      DispatchKey::Autograd, nullopt, nullopt, /*prev_grad_mode=*/true);
+  Tensor wrapped = makeTensorWrapper(at::ones({4}), level);
+
+  const auto ns = nsPerIter(iters, [&] {
+    auto out = at::add(wrapped, wrapped);
+  });
+
+  wrapped = Tensor();
+  popDynamicLayerAndDeleteMetadata();
+  return ns;
+}
+
+// One iteration of the sliced fallback loop. at::add has a batch rule, so we
+// can't reach the fallback by dispatching it normally; instead we call
+// batchedTensorForLoopFallback directly under the same TLS transition the
+// dispatcher performs (DynamicLayerKeySetGuard), which is also how the
+// per-slice calls reach the back fallback in production. The reported number
+// is per slice, not per fallback call.
+double benchFallbackSlice(int64_t iters, int64_t batch_size) {
+  const auto op =
+      c10::Dispatcher::singleton().findSchemaOrThrow("aten::add", "Tensor");
+  const auto level =
+      initAndPushDynamicLayer(kBatchedKey, batch_size, RandomnessType::Error);
+  Tensor batched = makeBatched(at::ones({batch_size, 4}), 0, level);
+
+  const bool warn_was_enabled = isVmapFallbackWarningEnabled();
+  setVmapFallbackWarningEnabled(false);
+  const auto ns = nsPerIter(iters, [&] {
+    DynamicLayerKeySetGuard guard(kBatchedKey);
+    torch::jit::Stack stack;
+    torch::jit::push(&stack, batched, batched, at::Scalar(1));
+    batchedTensorForLoopFallback(op, &stack);
+  });
+  setVmapFallbackWarningEnabled(warn_was_enabled);
+
+  batched = Tensor();
+  popDynamicLayerAndDeleteMetadata();
+  return ns / static_cast<double>(batch_size);
+}
+
+} // namespace
+
+std::vector<std::pair<std::string, double>>
+runDispatchOverheadBenchmarks(int64_t iters) {
+  TORCH_CHECK(iters > 0, "expected iters > 0, got ", iters);
+  TORCH_CHECK(
+      !areTransformsActive(),
+      "runDispatchOverheadBenchmarks: must be called with no transforms active");
+
+  std::vector<std::pair<std::string, double>> results;
+  results.emplace_back("dynamic_layer_push_pop", benchLayerPushPop(iters));
+  for (const auto depth : c10::irange(1, 4)) {
+    results.emplace_back(
+        "vmapped_add_depth" + std::to_string(depth),
+        benchVmappedAdd(iters, depth));
+  }
+  results.emplace_back("grad_wrapped_add", benchGradWrappedAdd(iters));
+  // The fallback loops over all slices per call, so run fewer iterations.
+  results.emplace_back(
+      "fallback_slice",
+      benchFallbackSlice(std::max<int64_t>(iters / 16, 1), /*batch_size=*/16));
+  return results;
+}
+
+}
+} // namespace at
@@ -0,0 +1,32 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree.
+#pragma once
+#include <c10/macros/Macros.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace at {
+namespace functorch {
+
+// NOTE: [Dispatch overhead microbenchmarks]
+// The Python scripts in benchmarks/ measure end-to-end time, which buries
+// per-op framework overhead (entering a dynamic layer, the generated
+// plumbing, the sliced fallback) under Python noise. These microbenchmarks
+// time the C++ dispatch paths directly and report ns/op for each path, so a
+// regression in DynamicLayer.cpp or VmapGeneratedPlumbing.h shows up as a
+// number instead of as model-level drift. Exposed to Python as
+// functorch._C._dispatch_overhead_benchmarks; benchmarks/cpp_dispatch_overhead.py
+// is the driver.
+//
+// Must be called with no transforms active; each benchmark pushes and pops
+// the dynamic layers it needs.
+TORCH_API std::vector<std::pair<std::string, double>>
+runDispatchOverheadBenchmarks(int64_t iters);
+
+}
+} // namespace at
@@ -7,6 +7,7 @@
 #include <functorch/csrc/DynamicLayer.h>
 #include <functorch/csrc/TensorWrapper.h>
 #include <functorch/csrc/BatchedTensorImpl.h>
+#include <functorch/csrc/TransformTracing.h>
 
 #include <torch/library.h>
 #include <c10/core/impl/LocalDispatchKeySet.h>
@@ -32,20 +33,6 @@ void setDynamicLayerFrontBackKeysIncluded(bool included) {
   c10::impl::tls_set_dispatch_key_included(kDynamicLayerBackModeKey, included);
 }
 
-struct ForceLocalDispatchKeySet {
- public:
-  ForceLocalDispatchKeySet(c10::impl::LocalDispatchKeySet key_set) :
-      saved_keyset_(c10::impl::tls_local_dispatch_key_set()) {
-    c10::impl::_force_tls_local_dispatch_key_set(key_set);
-  }
-  ~ForceLocalDispatchKeySet() {
-    c10::impl::_force_tls_local_dispatch_key_set(saved_keyset_);
-  }
-
- private:
-  c10::impl::LocalDispatchKeySet saved_keyset_;
-};
-
 DynamicLayer::DynamicLayer(
     DispatchKey key,
     int64_t layerId,
@@ -86,12 +73,11 @@ optional<bool> DynamicLayer::prevGradMode() const {
   return prevGradMode_;
 }
 
-using DynmetaData = std::unordered_map<int64_t, std::shared_ptr<bool>>;
-DynmetaData kDynMetaDataSingleton;
-
-static DynmetaData& getGlobalDynmetaData() {
-  return kDynMetaDataSingleton;
-}
+// See NOTE in DynamicLayer.h: liveness per level is a generation counter.
+// Odd generations are alive, even generations are dead. Entries start at 0
+// (dead) and are bumped on level creation and metadata deletion.
+std::array<std::atomic<int64_t>, kDynamicLayerMaxLevels> levelGenerationTable;
+static std::atomic<int64_t> numAliveLevels{0};
 
 class FuncTorchTLS : public FuncTorchTLSBase {
  public:
@@ -119,7 +105,7 @@ class FuncTorchTLS : public FuncTorchTLSBase {
 
   // Initial autograd layer, because autograd is always "on"
   // TODO: Get rid of this, it is bad for composability
-  std::vector<DynamicLayer> dynamicLayerStack = { DynamicLayer(DispatchKey::Autograd, 1, nullopt, nullopt, true) };
+  DynamicLayerStack dynamicLayerStack = { DynamicLayer(DispatchKey::Autograd, 1, nullopt, nullopt, true) };
 };
 
 static FuncTorchTLS* getRawFunctorchTLS() {
@@ -133,14 +119,15 @@ static FuncTorchTLS* getRawFunctorchTLS() {
   return result;
 }
 
-static std::vector<DynamicLayer>& dynamicLayerStackAccessor() {
+static DynamicLayerStack& dynamicLayerStackAccessor() {
   return getRawFunctorchTLS()->dynamicLayerStack;
 }
 
-std::shared_ptr<bool> getLifeHandleForLevel(int64_t level) {
-  auto it = getGlobalDynmetaData().find(level);
-  TORCH_INTERNAL_ASSERT(it != kDynMetaDataSingleton.end(), "level should be alive");
-  return it->second;
+int64_t getGenerationForLevel(int64_t level) {
+  TORCH_INTERNAL_ASSERT(level >= 0 && level < kDynamicLayerMaxLevels);
+  auto generation = levelGenerationTable[level].load(std::memory_order_relaxed);
+  TORCH_INTERNAL_ASSERT(generation % 2 == 1, "level should be alive");
+  return generation;
 }
 
 optional<DynamicLayer> maybeCurrentDynamicLayer() {
@@ -152,17 +139,16 @@ optional<DynamicLayer> maybeCurrentDynamicLayer() {
   return dynamicLayerStack.back();
 }
 
-const std::vector<DynamicLayer>& getDynamicLayerStack() {
+const DynamicLayerStack& getDynamicLayerStack() {
   return dynamicLayerStackAccessor();
 }
 
-void setDynamicLayerStack(const std::vector<DynamicLayer>& stack) {
+void setDynamicLayerStack(const DynamicLayerStack& stack) {
   dynamicLayerStackAccessor() = stack;
 }
 
 bool areTransformsActive() {
-  const auto& data = getGlobalDynmetaData();
-  return !data.empty();
+  return numAliveLevels.load(std::memory_order_relaxed) > 0;
 }
 
 static DynamicLayer popDynamicLayer() {
@@ -208,13 +194,15 @@ int64_t initAndPushDynamicLayer(
   DynamicLayer new_layer(key, layerId, batch_size, randomness, prev_grad_mode);
   pushDynamicLayer(std::move(new_layer));
 
-  auto& data = getGlobalDynmetaData();
-
-  TORCH_INTERNAL_ASSERT(data.find(layerId) == data.end());
   if (key == DispatchKey::Autograd) {
     TORCH_INTERNAL_ASSERT(prev_grad_mode.has_value());
   }
-  data[layerId] = std::make_shared<bool>(true);
+  TORCH_CHECK(layerId < kDynamicLayerMaxLevels,
+      "functorch transforms may only be nested ", kDynamicLayerMaxLevels, " deep");
+  // Mark the level as alive (even -> odd).
+  auto generation = levelGenerationTable[layerId].fetch_add(1, std::memory_order_relaxed);
+  TORCH_INTERNAL_ASSERT(generation % 2 == 0, "level is already alive");
+  numAliveLevels.fetch_add(1, std::memory_order_relaxed);
   return layerId;
 }
 
@@ -222,25 +210,19 @@ DynamicLayer popDynamicLayerAndDeleteMetadata() {
   auto result = popDynamicLayer();
   auto level = result.layerId();
 
-  // TODO: is this lock safe? No one else should be writing to the same bucket
-  // if (c10::show_dispatch_trace_enabled()) {
-  //   std::cout << "deleting metadata" << std::endl;
-  // }
-  auto& data = getGlobalDynmetaData();
-  auto it = data.find(level);
-  if (it == data.end()) {
+  // The initial autograd layer never went through initAndPushDynamicLayer,
+  // so it has no liveness entry to invalidate.
+  if (levelGenerationTable[level].load(std::memory_order_relaxed) % 2 == 0) {
     return result;
   }
-  // if (c10::show_dispatch_trace_enabled()) {
-  //   std::cout << "deleted metadata for level " << level << std::endl;
-  // }
-  // invalidate the thing
-  *(it->second) = false;
-  data.erase(level);
+  // Invalidate the level (odd -> even); wrappers holding the old generation
+  // are now dead.
+  levelGenerationTable[level].fetch_add(1, std::memory_order_relaxed);
+  numAliveLevels.fetch_sub(1, std::memory_order_relaxed);
   return result;
 }
 
-static Tensor materializeGradWrappers(const Tensor& tensor, const std::vector<DynamicLayer>& dynlayerStack) {
+static Tensor materializeGradWrappers(const Tensor& tensor, const DynamicLayerStack& dynlayerStack) {
   if (!tensor.defined()) {
     return tensor;
   }
@@ -252,6 +234,13 @@ static Tensor materializeGradWrappers(const Tensor& tensor, const std::vector<Dy
   if (dynlayerStack.back().key() != DispatchKey::Autograd) {
     return tensor;
   }
+  // Non-differentiable dtypes can never require grad, so autograd at this
+  // level treats them as constants whether or not they are wrapped. Skip the
+  // wrapper allocation; integer-heavy models otherwise churn a TensorWrapper
+  // per index tensor per op.
+  if (!tensor.is_floating_point() && !tensor.is_complex()) {
+    return tensor;
+  }
   auto cur_level = dynlayerStack.back().layerId();
   auto* wrapper = maybeGetTensorWrapper(tensor);
   if (!wrapper) {
@@ -266,14 +255,9 @@ static Tensor materializeGradWrappers(const Tensor& tensor, const std::vector<Dy
 }
 
 static Tensor unwrapIfDead(const Tensor& tensor) {
-  auto* wrapped = maybeGetTensorWrapper(tensor);
-  if (!wrapped) {
-    return tensor;
-  }
-  if (wrapped->is_alive()) {
-    return tensor;
-  }
-  return wrapped->value();
+  // Peels every dead wrapper in one pass rather than one per dispatch;
+  // see NOTE: [Single-pass unwrapping].
+  return peelWrappedLayers(tensor);
 }
 
 void foreachTensorInplace(std::vector<IValue>& args, int64_t begin, int64_t end,
@@ -282,50 +266,106 @@ void foreachTensorInplace(std::vector<IValue>& args, int64_t begin, int64_t end,
   TORCH_INTERNAL_ASSERT(end >= 0);
   TORCH_INTERNAL_ASSERT(begin <= end);
   for (int64_t idx = begin; idx < end; idx++) {
-    auto ivalue = args[idx];
+    // NB: visit the IValue in place. Copying it out of the stack bumps
+    // refcounts for every argument of every op that goes through the
+    // fallbacks, which adds up.
+    const auto& ivalue = args[idx];
     // Tensor?[] translates to a c10::List<IValue> so we need to peek inside List
     if (ivalue.isList()) {
+      // Scan first; only clone the list if a member actually changes.
       bool modified = false;
-      // TODO: might be more efficient if we scan first then not copy? Depends.
-      auto list = ivalue.toList().copy();
-      for (const auto list_idx : c10::irange(0, list.size())) {
-        const auto& elt = list.get(list_idx);
-        if (elt.isTensor()) {
-          list.set(list_idx, func(elt.toTensor()));
+      c10::List<IValue> replacement_list;
+      const auto elts = ivalue.toListRef();
+      for (const auto list_idx : c10::irange(0, elts.size())) {
+        const auto& elt = elts[list_idx];
+        if (!elt.isTensor()) {
+          continue;
+        }
+        const auto& tensor = elt.toTensor();
+        Tensor replacement = func(tensor);
+        if (replacement.unsafeGetTensorImpl() == tensor.unsafeGetTensorImpl()) {
+          continue;
+        }
+        if (!modified) {
+          replacement_list = ivalue.toList().copy();
           modified = true;
         }
+        replacement_list.set(list_idx, std::move(replacement));
       }
       if (modified) {
-        args[idx] = list;
+        args[idx] = std::move(replacement_list);
       }
       continue;
     }
     if (ivalue.isTensorList()) {
       auto list = ivalue.toTensorList();
       for (const auto list_idx : c10::irange(0, list.size())) {
-        list[list_idx] = func(list[list_idx]);
+        const Tensor tensor = list.get(list_idx);
+        Tensor replacement = func(tensor);
+        if (replacement.unsafeGetTensorImpl() == tensor.unsafeGetTensorImpl()) {
+          continue;
+        }
+        list[list_idx] = std::move(replacement);
       }
-      args[idx] = list;
+      continue;
     }
     TORCH_INTERNAL_ASSERT(!ivalue.isGenericDict(), "No operators can accept GenericDict");
     if (!ivalue.isTensor()) {
       continue;
     }
-    Tensor value = ivalue.toTensor();
+    const auto& value = ivalue.toTensor();
     Tensor replacement = func(value);
+    if (replacement.unsafeGetTensorImpl() == value.unsafeGetTensorImpl()) {
+      // func returned the tensor unchanged; skip the write-back (and the
+      // refcount churn that comes with it).
+      continue;
+    }
+    const bool was_defined = value.defined();
     args[idx] = std::move(replacement);
     // sanity checks
-    if (ivalue.toTensor().defined()) {
+    if (was_defined) {
       TORCH_INTERNAL_ASSERT(args[idx].toTensor().defined());
     }
   }
 }
 
+// Read-only companion to foreachTensorInplace: returns true as soon as
+// pred(tensor) holds for any tensor argument (including inside lists).
+// Lets callers skip the rewrite pass entirely when nothing would change.
+template <typename Pred>
+static bool anyTensorInStack(const std::vector<IValue>& args, int64_t begin, int64_t end,
+    Pred pred) {
+  for (int64_t idx = begin; idx < end; idx++) {
+    const auto& ivalue = args[idx];
+    if (ivalue.isList()) {
+      for (const auto& elt : ivalue.toListRef()) {
+        if (elt.isTensor() && pred(elt.toTensor())) {
+          return true;
+        }
+      }
+      continue;
+    }
+    if (ivalue.isTensorList()) {
+      const auto list = ivalue.toTensorList();
+      for (const auto list_idx : c10::irange(0, list.size())) {
+        if (pred(list.get(list_idx))) {
+          return true;
+        }
+      }
+      continue;
+    }
+    if (ivalue.isTensor() && pred(ivalue.toTensor())) {
+      return true;
+    }
+  }
+  return false;
+}
+
 std::ostream& operator<< (std::ostream& os, const DynamicLayer& layer) {
   os << layer.layerId() << ":" << layer.key();
   return os;
 }
-std::ostream& operator<< (std::ostream& os, const std::vector<DynamicLayer>& dls) {
+std::ostream& operator<< (std::ostream& os, const DynamicLayerStack& dls) {
   os << "DynamicLayerStack[ ";
   for (const auto& layer : dls) {
     os << layer << " ";
@@ -371,7 +411,7 @@ bool isInplaceOp(const FunctionSchema& schema) {
 static void checkForInvalidMutationOnCaptures(
     const c10::OperatorHandle& op,
     torch::jit::Stack* stack,
-    const std::vector<DynamicLayer>& dynamicLayerStack) {
+    const DynamicLayerStack& dynamicLayerStack) {
   if (dynamicLayerStack.back().key() != DispatchKey::Autograd) {
     return;
   }
@@ -426,8 +466,45 @@ static DispatchKeySet keysToExcludeWhenEnteringDynamicLayer(DispatchKey key) {
   return exclude;
 }
 
+const DynamicLayerKeySets& keySetsForDynamicLayer(DispatchKey key) {
+  static const DynamicLayerKeySets batched_key_sets = {
+    keysToExcludeWhenEnteringDynamicLayer(kBatchedKey),
+    // NB: kVmapModeKey is the "hacky include"; we may modulate the key when
+    // constructing the DynamicLayer, but we don't control it when
+    // entering/exiting the DynamicLayer.
+    DispatchKeySet(kVmapModeKey)
+  };
+  static const DynamicLayerKeySets autograd_key_sets = {
+    keysToExcludeWhenEnteringDynamicLayer(DispatchKey::Autograd),
+    DispatchKeySet()
+  };
+  if (key == kBatchedKey) {
+    return batched_key_sets;
+  }
+  TORCH_INTERNAL_ASSERT(key == DispatchKey::Autograd, "Unsupported key: ", key);
+  return autograd_key_sets;
+}
+
+DynamicLayerKeySetGuard::DynamicLayerKeySetGuard(DispatchKey key)
+    : saved_keyset_(c10::impl::tls_local_dispatch_key_set()) {
+  const auto& key_sets = keySetsForDynamicLayer(key);
+  auto local_keyset = saved_keyset_;
+  local_keyset.excluded_ = local_keyset.excluded_ | key_sets.exclude;
+  local_keyset.included_ = local_keyset.included_ | key_sets.include;
+  c10::impl::_force_tls_local_dispatch_key_set(local_keyset);
+}
+
+DynamicLayerKeySetGuard::~DynamicLayerKeySetGuard() {
+  c10::impl::_force_tls_local_dispatch_key_set(saved_keyset_);
+}
+
 void dynamicLayerFrontFallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
   auto& dynamicLayerStack = dynamicLayerStackAccessor();
+  // See NOTE: [Transform event tracing]
+  TransformTraceGuard trace_guard(
+      op.schema().name().c_str(),
+      dynamicLayerStack.empty() ? kDynamicLayerFrontModeKey : dynamicLayerStack.back().key(),
+      dynamicLayerStack.empty() ? -1 : dynamicLayerStack.back().layerId());
 #ifdef HAS_TORCH_SHOW_DISPATCH_TRACE
   if (c10::show_dispatch_trace_enabled()) {
     std::cout << dynamicLayerStack << std::endl;
@@ -447,25 +524,42 @@ void dynamicLayerFrontFallback(const c10::OperatorHandle& op, torch::jit::Stack*
   checkForInvalidMutationOnCaptures(op, stack, dynamicLayerStack);
 
   // Unwrap dead GradWrappers, materialize live ones
-  auto maybeTransformGradWrappers = [](const Tensor& tensor) {
+  auto maybeTransformGradWrappers = [&](const Tensor& tensor) {
     auto result = unwrapIfDead(tensor);
-    return materializeGradWrappers(result, getDynamicLayerStack());
+    return materializeGradWrappers(result, dynamicLayerStack);
+  };
+  // Pre-scan: most ops' arguments need no rewrapping (already wrapped at the
+  // current level, non-differentiable dtype, or not a grad transform at all).
+  // The predicate mirrors unwrapIfDead + materializeGradWrappers; keep them
+  // in sync. When nothing would change, we leave the stack untouched instead
+  // of running the rewrite pass.
+  const bool wants_grad_wrappers = dynamicLayerStack.size() > 1 &&
+      dynamicLayerStack.back().key() == DispatchKey::Autograd;
+  const auto scan_level = dynamicLayerStack.back().layerId();
+  auto needsTransform = [&](const Tensor& tensor) {
+    if (!tensor.defined()) {
+      return false;
+    }
+    auto* wrapper = maybeGetTensorWrapper(tensor);
+    if (wrapper && !wrapper->is_alive()) {
+      return true;  // unwrapIfDead would strip it
+    }
+    if (!wants_grad_wrappers) {
+      return false;
+    }
+    if (!tensor.is_floating_point() && !tensor.is_complex()) {
+      return false;
+    }
+    return !(wrapper && wrapper->level().value() == scan_level);
   };
   auto num_args = op.schema().arguments().size();
-  foreachTensorInplace(*stack, stack->size() - num_args, stack->size(), maybeTransformGradWrappers);
+  if (anyTensorInStack(*stack, stack->size() - num_args, stack->size(), needsTransform)) {
+    foreachTensorInplace(*stack, stack->size() - num_args, stack->size(), maybeTransformGradWrappers);
+  }
 
-  auto layer = dynamicLayerStack.back();
+  const auto& layer = dynamicLayerStack.back();
 
-  DispatchKeySet exclude = keysToExcludeWhenEnteringDynamicLayer(layer.key());
-  DispatchKeySet hacky_include;
-  // hack
-  if (layer.key() == kBatchedKey) {
-    hacky_include = hacky_include.add(kVmapModeKey);
-  }
-  auto local_keyset = c10::impl::tls_local_dispatch_key_set();
-  local_keyset.excluded_ = local_keyset.excluded_ | exclude;
-  local_keyset.included_ = local_keyset.included_ | hacky_include;
-  ForceLocalDispatchKeySet guard(local_keyset);
+  DynamicLayerKeySetGuard guard(layer.key());
 
 #ifdef HAS_TORCH_SHOW_DISPATCH_TRACE
   if (c10::show_dispatch_trace_enabled()) {
@@ -500,10 +594,15 @@ struct SaveLocalDispatchKeySet {
 };
 
 void dynamicLayerBackFallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
-  auto cur_level = getDynamicLayerStack().back().layerId();
-  auto cur_key = getDynamicLayerStack().back().key();
-
-  optional<bool> prev_grad_mode = getDynamicLayerStack().back().prevGradMode();
+  // One TLS read; the accessor chain is not free and we need the top
+  // frame several times below.
+  const auto& layer = dynamicLayerStackAccessor().back();
+  auto cur_level = layer.layerId();
+  auto cur_key = layer.key();
+  // See NOTE: [Transform event tracing]
+  TransformTraceGuard trace_guard(op.schema().name().c_str(), cur_key, cur_level);
+
+  optional<bool> prev_grad_mode = layer.prevGradMode();
   if (cur_key == DispatchKey::Autograd) {
     TORCH_INTERNAL_ASSERT(prev_grad_mode.has_value());
   }
@@ -512,16 +611,9 @@ void dynamicLayerBackFallback(const c10::OperatorHandle& op, torch::jit::Stack*
     if (!tensor.defined()) {
       return tensor;
     }
-    auto* maybe_tensor_wrapper = maybeGetTensorWrapper(tensor);
-    if (!maybe_tensor_wrapper) {
-      return tensor;
-    }
-    auto tensor_wrapper_level = maybe_tensor_wrapper->level().value();
-    TORCH_INTERNAL_ASSERT(tensor_wrapper_level <= cur_level);
-    if (tensor_wrapper_level == cur_level) {
-      return maybe_tensor_wrapper->value();
-    }
-    return tensor;
+    // Peels this level's wrapper and any dead wrappers underneath in one
+    // pass; see NOTE: [Single-pass unwrapping].
+    return peelWrappedLayers(tensor, cur_level);
   };
   auto wrap = [&](const Tensor& tensor) {
     if (!tensor.defined()) {
@@ -530,6 +622,11 @@ void dynamicLayerBackFallback(const c10::OperatorHandle& op, torch::jit::Stack*
     if (cur_level == 1) {
       return tensor;
     }
+    // Matches the skip in materializeGradWrappers: outputs that can't carry
+    // grad don't need a wrapper announcing their level.
+    if (!tensor.is_floating_point() && !tensor.is_complex()) {
+      return tensor;
+    }
     // if (c10::show_dispatch_trace_enabled()) {
     //   std::cout << "wrap " << cur_level << std::endl;
     // }
@@ -6,8 +6,12 @@
 
 #pragma once
 #include <c10/core/DispatchKey.h>
+#include <c10/core/impl/LocalDispatchKeySet.h>
 #include <ATen/core/function_schema.h>
 #include <c10/util/Optional.h>
+#include <c10/util/SmallVector.h>
+#include <array>
+#include <atomic>
 #include <unordered_map>
 #include <mutex>
 
@@ -52,6 +56,13 @@ struct TORCH_API DynamicLayer {
   optional<bool> prevGradMode_;
 };
 
+// The dynamic layer stack lives in TLS and is pushed/popped once per
+// transformed call, so give it inline storage: transforms rarely nest more
+// than a few deep and we don't want a heap allocation per thread (or per
+// TLS deepcopy).
+constexpr int64_t kDynamicLayerStackInlineSize = 5;
+using DynamicLayerStack = c10::SmallVector<DynamicLayer, kDynamicLayerStackInlineSize>;
+
 TORCH_API int64_t initAndPushDynamicLayer(
     DispatchKey key,
     optional<int64_t> batch_size = nullopt,
@@ -59,16 +70,54 @@ TORCH_API int64_t initAndPushDynamicLayer(
     optional<bool> prev_grad_mode = nullopt);
 TORCH_API DynamicLayer popDynamicLayerAndDeleteMetadata();
 TORCH_API c10::optional<DynamicLayer> maybeCurrentDynamicLayer();
-TORCH_API const std::vector<DynamicLayer>& getDynamicLayerStack();
-TORCH_API void setDynamicLayerStack(const std::vector<DynamicLayer>& stack);
+TORCH_API const DynamicLayerStack& getDynamicLayerStack();
+TORCH_API void setDynamicLayerStack(const DynamicLayerStack& stack);
 TORCH_API void setDynamicLayerFrontBackKeysIncluded(bool included);
 
-// NB: Not lock safe, you should only call this from Python where the GIL will
-// prevent race conditions.
 TORCH_API bool areTransformsActive();
 
-// NB: not lock safe. TODO: does it need a lock?
-TORCH_API std::shared_ptr<bool> getLifeHandleForLevel(int64_t level);
+// dynamicLayerFrontFallback runs on every dispatched op inside a transform, so
+// we don't want to rebuild the exclude/include keysets (branches and set
+// arithmetic) per call. Instead, precompute them once per layer key at static
+// init time; entering a layer is then two loads and two ORs.
+struct DynamicLayerKeySets {
+  DispatchKeySet exclude;
+  DispatchKeySet include;
+};
+
+TORCH_API const DynamicLayerKeySets& keySetsForDynamicLayer(DispatchKey key);
+
+// RAII guard that ORs `key`'s precomputed exclude/include sets into the local
+// dispatch keyset -- the same TLS transition dynamicLayerFrontFallback
+// performs before its boxed re-dispatch. Generated unboxed fast paths use
+// this to enter the top layer without going back through the dispatcher.
+struct TORCH_API DynamicLayerKeySetGuard {
+  explicit DynamicLayerKeySetGuard(DispatchKey key);
+  ~DynamicLayerKeySetGuard();
+
+ private:
+  c10::impl::LocalDispatchKeySet saved_keyset_;
+};
+
+// Level liveness is a fixed-size generation table indexed by level (levels
+// are bounded by kVmapNumLevels anyway). Pushing a level bumps its
+// generation to an odd (alive) value; deleting the level's metadata bumps
+// it again. A TensorWrapper remembers the generation it was created under,
+// so is_alive() is a single relaxed atomic load and an equality check --
+// no shared_ptr refcount traffic per wrapped tensor per op.
+constexpr int64_t kDynamicLayerMaxLevels = 64;
+// Generation that never matches a live table entry; used for wrappers
+// that are created dead (e.g. by shallow_copy_and_detach).
+constexpr int64_t kDeadGeneration = -1;
+TORCH_API extern std::array<std::atomic<int64_t>, kDynamicLayerMaxLevels> levelGenerationTable;
+
+// Returns the current (alive) generation for `level`; asserts that the
+// level is actually alive.
+TORCH_API int64_t getGenerationForLevel(int64_t level);
+
+inline bool isLevelGenerationAlive(int64_t level, int64_t generation) {
+  return levelGenerationTable[level].load(std::memory_order_relaxed) == generation;
+}
 
 // Returns if an operator is in-place. An operator is inplace if:
 // 1. The first argument is a Tensor and it is being written to
@@ -81,12 +130,14 @@ bool isInplaceOp(const c10::FunctionSchema& schema);
 // Applies the following for-loop:
 // for i in range(begin, end):
 //   args[i] = func(args[i])
+// Visits IValues in place and only writes a slot back (or clones a
+// Tensor?[] list) when func actually returned a different tensor.
 void foreachTensorInplace(std::vector<IValue>& args, int64_t begin, int64_t end,
     std::function<Tensor(const Tensor&)> func);
 
 // Pretty printers
 std::ostream& operator<<(std::ostream& os, const DynamicLayer& layer);
-std::ostream& operator<<(std::ostream& os, const std::vector<DynamicLayer>& dynamicLayerStack);
+std::ostream& operator<<(std::ostream& os, const DynamicLayerStack& dynamicLayerStack);
 
 }
 } // namespace at
@@ -0,0 +1,170 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <functorch/csrc/MinCut.h>
+
+#include <c10/util/Exception.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace at {
+namespace functorch {
+
+namespace {
+
+// Residual capacities below this are treated as saturated. Capacities are
+// tensor byte counts (or +inf), so anything smaller is floating-point dust.
+constexpr double kResidualEps = 1e-9;
+
+// Dinic's algorithm over a CSR adjacency. Every input edge gets a paired
+// residual edge of capacity zero; `rev` maps each edge to its pair.
+struct CSRMaxFlow {
+  int64_t n;
+  std::vector<int64_t> offsets; // n + 1 prefix offsets into the edge arrays
+  std::vector<int64_t> to;
+  std::vector<int64_t> rev;
+  std::vector<double> cap;
+  std::vector<int64_t> level;
+  std::vector<int64_t> iter;
+
+  CSRMaxFlow(
+      int64_t num_vertices,
+      const std::vector<int64_t>& edge_src,
+      const std::vector<int64_t>& edge_dst,
+      const std::vector<double>& edge_cap)
+      : n(num_vertices),
+        offsets(num_vertices + 1, 0),
+        level(num_vertices),
+        iter(num_vertices) {
+    const int64_t num_edges = edge_src.size();
+    for (const auto e : c10::irange(num_edges)) {
+      offsets[edge_src[e] + 1]++;
+      offsets[edge_dst[e] + 1]++;
+    }
+    for (const auto v : c10::irange(n)) {
+      offsets[v + 1] += offsets[v];
+    }
+    to.resize(2 * num_edges);
+    rev.resize(2 * num_edges);
+    cap.resize(2 * num_edges);
+    std::vector<int64_t> fill(offsets.begin(), offsets.end() - 1);
+    for (const auto e : c10::irange(num_edges)) {
+      const auto fwd = fill[edge_src[e]]++;
+      const auto bwd = fill[edge_dst[e]]++;
+      to[fwd] = edge_dst[e];
+      to[bwd] = edge_src[e];
+      rev[fwd] = bwd;
+      rev[bwd] = fwd;
+      cap[fwd] = edge_cap[e];
+      cap[bwd] = 0.0;
+    }
+  }
+
+  bool bfs(int64_t source, int64_t sink) {
+    std::fill(level.begin(), level.end(), -1);
+    std::vector<int64_t> queue;
+    queue.reserve(n);
+    queue.push_back(source);
+    level[source] = 0;
+    for (size_t head = 0; head < queue.size(); ++head) {
+      const auto v = queue[head];
+      for (auto e = offsets[v]; e < offsets[v + 1]; ++e) {
+        if (cap[e] > kResidualEps && level[to[e]] < 0) {
+          level[to[e]] = level[v] + 1;
+          queue.push_back(to[e]);
+        }
+      }
+    }
+    return level[sink] >= 0;
+  }
+
+  double dfs(int64_t v, int64_t sink, double pushed) {
+    if (v == sink) {
+      return pushed;
+    }
+    for (auto& e = iter[v]; e < offsets[v + 1]; ++e) {
+      const auto u = to[e];
+      if (cap[e] <= kResidualEps || level[u] != level[v] + 1) {
+        continue;
+      }
+      const auto flow = dfs(u, sink, std::min(pushed, cap[e]));
+      if (flow > kResidualEps) {
+        cap[e] -= flow;
+        cap[rev[e]] += flow;
+        return flow;
+      }
+    }
+    return 0.0;
+  }
+
+  void maxflow(int64_t source, int64_t sink) {
+    while (bfs(source, sink)) {
+      std::copy(offsets.begin(), offsets.end() - 1, iter.begin());
+      while (true) {
+        const auto flow =
+            dfs(source, sink, std::numeric_limits<double>::infinity());
+        if (flow <= kResidualEps) {
+          break;
+        }
+        TORCH_CHECK(
+            std::isfinite(flow),
+            "minCutReachable: the cut is unbounded; an infinite-capacity ",
+            "source-to-sink path exists");
+      }
+    }
+  }
+};
+
+} // namespace
+
+std::vector<int64_t> minCutReachable(
+    int64_t num_vertices,
+    const std::vector<int64_t>& edge_src,
+    const std::vector<int64_t>& edge_dst,
+    const std::vector<double>& edge_cap,
+    int64_t source,
+    int64_t sink) {
+  TORCH_CHECK(
+      edge_src.size() == edge_dst.size() && edge_src.size() == edge_cap.size(),
+      "minCutReachable: edge arrays must have equal length");
+  TORCH_CHECK(
+      source >= 0 && source < num_vertices && sink >= 0 &&
+          sink < num_vertices && source != sink,
+      "minCutReachable: invalid source/sink");
+  for (const auto e : c10::irange(edge_src.size())) {
+    TORCH_CHECK(
+        edge_src[e] >= 0 && edge_src[e] < num_vertices && edge_dst[e] >= 0 &&
+            edge_dst[e] < num_vertices,
+        "minCutReachable: edge endpoint out of range");
+    TORCH_CHECK(
+        edge_cap[e] >= 0, "minCutReachable: capacities must be non-negative");
+  }
+
+  CSRMaxFlow graph(num_vertices, edge_src, edge_dst, edge_cap);
+  graph.maxflow(source, sink);
+
+  // The source side of the cut: vertices reachable in the residual graph.
+  std::vector<bool> seen(num_vertices, false);
+  std::vector<int64_t> reachable;
+  reachable.push_back(source);
+  seen[source] = true;
+  for (size_t head = 0; head < reachable.size(); ++head) {
+    const auto v = reachable[head];
+    for (auto e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+      if (graph.cap[e] > kResidualEps && !seen[graph.to[e]]) {
+        seen[graph.to[e]] = true;
+        reachable.push_back(graph.to[e]);
+      }
+    }
+  }
+  return reachable;
+}
+
+}
+} // namespace at
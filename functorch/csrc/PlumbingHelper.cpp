@@ -28,14 +28,18 @@ std::vector<Tensor> makeBatchedVector(const std::vector<Tensor>& tensors, option
 }
 
 std::tuple<Tensor, optional<int64_t>> unwrapTensorAtLevel(const Tensor& tensor, int64_t level) {
-  auto* batched = maybeGetBatchedImpl(tensor);
+  // Strip dead grad wrappers above and below the batched layer in the same
+  // pass, so interleaved grad-vmap stacks don't pay one dispatch round trip
+  // per dead layer. See NOTE: [Single-pass unwrapping].
+  const Tensor& peeled = peelWrappedLayers(tensor);
+  auto* batched = maybeGetBatchedImpl(peeled);
   if (!batched) {
-    return std::make_tuple(tensor, nullopt);
+    return std::make_tuple(peeled, nullopt);
   }
   if (batched->level() == level) {
-    return std::make_tuple(batched->value(), batched->bdim());
+    return std::make_tuple(peelWrappedLayers(batched->value()), batched->bdim());
   }
-  return std::make_tuple(tensor, nullopt);
+  return std::make_tuple(peeled, nullopt);
 }
 
 bool isBatchedAtLevel(const Tensor& tensor, int64_t level) {
@@ -78,5 +82,14 @@ bool areAnyBatchedAtLevel(ArrayRef<optional<Tensor>> maybe_tensors, int64_t leve
   return false;
 }
 
+bool anyTensorIsGradWrapped(ArrayRef<Tensor> tensors) {
+  for (const auto& tensor : tensors) {
+    if (maybeGetTensorWrapper(tensor)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 
 }}
@@ -25,6 +25,11 @@ bool isBatchedAtLevel(const c10::optional<Tensor>& maybe_tensor, int64_t level);
 // Convenience helper. Returns true if any tensor is batched at level
 bool areAnyBatchedAtLevel(ArrayRef<optional<Tensor>> maybe_tensors, int64_t level);
 
+// Returns true if any tensor is wrapped in a TensorWrapper (grad transform
+// wrapper). Used by generated unboxed fast paths to check that none of the
+// args need the front fallback's materialize/unwrap pass.
+bool anyTensorIsGradWrapped(ArrayRef<Tensor> tensors);
+
 inline bool ivalueParticipatesInCurrentLevel(const IValue& ivalue) {
   if (ivalue.isTensor()) {
     auto maybe_level = maybeCurrentDynamicLayer();
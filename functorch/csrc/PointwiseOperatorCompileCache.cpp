@@ -40,6 +40,9 @@
 #include <torch/csrc/jit/tensorexpr/codegen.h>
 #include <torch/csrc/utils/pybind.h>
 
+#include <mutex>
+#include <shared_mutex>
+
 using namespace torch::jit::tensorexpr;
 
 namespace {
@@ -85,12 +88,13 @@ template <int MAX_DIMS> struct SpecializationKey {
       : flags_(packFlags(state, v)), aliasGroup_(aliasGroup),
         dispatchKey_(state.apply(v.key_set()).raw_repr()) {
     initDimflags(v.sizes(), v.strides(), v.ndimension());
+    initVectorFlags(v.sizes(), v.ndimension());
   }
 
   /// Compare key to other and return 0 if equal, <0 if key is less
   /// than other, or >0 if key is greater than other.
   bool operator<(const SpecializationKey<MAX_DIMS> &other) const {
-    static_assert(sizeof(SpecializationKey<MAX_DIMS>) == 10 + MAX_DIMS,
+    static_assert(sizeof(SpecializationKey<MAX_DIMS>) == 11 + MAX_DIMS,
                   "struct is not packed, memcmp requires no padding");
     return memcmp(this, &other, sizeof(SpecializationKey<MAX_DIMS>)) < 0;
   }
@@ -142,6 +146,21 @@ template <int MAX_DIMS> struct SpecializationKey {
     return result;
   }
 
+  /// Widest SIMD bucket (16/8/4 lanes, else 1) the innermost extent
+  /// divides into; used by the codegen to emit tail-free vector loops.
+  int vectorWidth() const {
+    if ((vectorFlags_ & VECTOR_16) > 0) {
+      return 16;
+    }
+    if ((vectorFlags_ & VECTOR_8) > 0) {
+      return 8;
+    }
+    if ((vectorFlags_ & VECTOR_4) > 0) {
+      return 4;
+    }
+    return 1;
+  }
+
   /// Convert this specialization key to a python namedtuple.
   py::object toPython(const at::Tensor &example, bool is_out) const {
     // Create the python specialization key type (a namedtuple) lazily.
@@ -151,13 +170,13 @@ template <int MAX_DIMS> struct SpecializationKey {
           py::module_::import("collections").attr("namedtuple");
       return namedtuple("SpecializationKey",
                         "alias_group,ndim,dtype,device,layout,requires_grad,"
-                        "out,shape,stride");
+                        "out,shape,stride,vector_width");
     }();
     py::object ex = py::cast(example);
     return keyType(static_cast<int>(aliasGroup_), ex.attr("ndim"),
                    ex.attr("dtype"), ex.attr("device"), ex.attr("layout"),
                    ex.attr("requires_grad"), py::bool_(is_out), shape(),
-                   stride());
+                   stride(), vectorWidth());
   }
 
 private:
@@ -191,6 +210,15 @@ private:
     STRIDE_AS_ARG = 1 << 7,
   };
 
+  /// Divisibility of the innermost extent, so kernels can specialize on
+  /// SIMD-width buckets without a scalar tail. A flag being set means the
+  /// innermost (trailing) dim size is a multiple of that lane count.
+  enum VectorFlags {
+    VECTOR_4 = 1 << 0,
+    VECTOR_8 = 1 << 1,
+    VECTOR_16 = 1 << 2,
+  };
+
   /// Initialize the shape flags for each dimension.
   void initDimflags(c10::IntArrayRef sizes, c10::IntArrayRef strides,
                     int64_t ndims) {
@@ -219,6 +247,23 @@ private:
     }
   }
 
+  /// Initialize the SIMD divisibility flags from the innermost extent.
+  void initVectorFlags(c10::IntArrayRef sizes, int64_t ndims) {
+    vectorFlags_ = 0;
+    if (ndims > 0) {
+      int64_t innermost = sizes[ndims - 1];
+      if (innermost % 4 == 0) {
+        vectorFlags_ |= VECTOR_4;
+      }
+      if (innermost % 8 == 0) {
+        vectorFlags_ |= VECTOR_8;
+      }
+      if (innermost % 16 == 0) {
+        vectorFlags_ |= VECTOR_16;
+      }
+    }
+  }
+
 private:
   /// Packed field with requires_grad and dtype.
   uint8_t flags_;
@@ -232,6 +277,9 @@ private:
   /// DispatchKeySet includes device/layout.
   uint64_t dispatchKey_;
 
+  /// SIMD divisibility of the innermost extent, see VectorFlags.
+  uint8_t vectorFlags_;
+
   /// Per-dimension shape flags.
   // NOLINTNEXTLINE: C-style arrays
   uint8_t dimflags_[MAX_DIMS];
@@ -411,6 +459,10 @@ struct PointwiseOperatorCompileResult
     for (int i = 0; i < Counts::numOutAllocated; ++i) {
       int optionsFrom = allocatedOutputs_[i].first;
       auto &outputOrder = allocatedOutputs_[i].second;
+      // The storage order also fixes the output rank. Reduction kernels
+      // iterate over more dims than they produce: the trailing (reduced)
+      // iteration dims are dropped from the allocated output.
+      int outNdims = outputOrder.size();
       // NOLINTNEXTLINE: C-style arrays
       int64_t strides[MAX_DIMS];
       int64_t nextStride = 1;
@@ -419,16 +471,17 @@ struct PointwiseOperatorCompileResult
         nextStride *= shapes[j];
       }
       args[allocatedArgsOffset + i] =
-          at::empty_strided(c10::IntArrayRef(shapes, shapes + ndims),
-                            c10::IntArrayRef(strides, strides + ndims),
+          at::empty_strided(c10::IntArrayRef(shapes, shapes + outNdims),
+                            c10::IntArrayRef(strides, strides + outNdims),
                             args[optionsFrom].options());
       callArgs[allocatedArgsOffset + i] =
           args[allocatedArgsOffset + i].data_ptr();
     }
 
     // Release the GIL before calling the kernel, unless the kernel is
-    // tiny.
-    if (numel < 128) {
+    // tiny or this thread doesn't hold it to begin with (C++ inter-op
+    // threads reach here GIL-free; see NOTE: [GIL-free cache hits]).
+    if (numel < 128 || !PyGILState_Check()) {
       // TODO(jansel): should we also skip releasing the GIL on GPU?
       cg_->call_with_numel(callArgs, numel);
     } else {
@@ -541,14 +594,37 @@ private:
   }
 
   /// Retrieve a kernel from cache or compile if not found.
+  ///
+  /// NOTE: [GIL-free cache hits]
+  /// Kernels driven from C++ inter-op threads (see call() below and
+  /// CompiledAutoGradNode) must not serialize on the GIL just to probe the
+  /// cache: the key is a fixed-arity memcmp-able struct and the probe
+  /// allocates nothing, so a reader lock is all a hit needs. Only a miss,
+  /// which calls back into the Python compileFn_, touches the GIL -- and it
+  /// acquires the GIL *before* the writer lock, so the lock order is always
+  /// GIL -> mutex_ and a reader already holding the GIL can't deadlock a
+  /// compiling writer.
   CachedResult *cachedCompile(const SpecializationKeys &key, at::Tensor *args) {
-    auto item = cache_.find(key); // protected by GIL
-    if (C10_LIKELY(item != cache_.end())) {
-      return item->second.get();
-    } else { // cache miss
-      auto iter = cache_.emplace(key, compile(key, args)).first;
-      return iter->second.get();
+    {
+      std::shared_lock<std::shared_timed_mutex> reader(mutex_);
+      auto item = cache_.find(key);
+      if (C10_LIKELY(item != cache_.end())) {
+        // Entries are never erased and unique_ptr targets are stable, so the
+        // pointer remains valid after the lock is dropped.
+        return item->second.get();
+      }
     }
+    // Cache miss: compilation calls into Python, so take the GIL (a no-op on
+    // the pyCall path, which already holds it). Compile outside the writer
+    // lock; holding the mutex across an arbitrary Python callback could
+    // block readers for the whole compilation.
+    py::gil_scoped_acquire gil;
+    auto compiled = compile(key, args);
+    std::unique_lock<std::shared_timed_mutex> writer(mutex_);
+    // Two threads may race to compile the same key; emplace keeps the first
+    // insert and the loser's result is discarded.
+    auto iter = cache_.emplace(key, std::move(compiled)).first;
+    return iter->second.get();
   }
 
   /// Verify that the current set of dispatch keys is supported by
@@ -636,6 +712,9 @@ private:
   /// Storage for the cache.
   Cache cache_;
 
+  /// Guards cache_; see NOTE: [GIL-free cache hits].
+  std::shared_timed_mutex mutex_;
+
   /// The compilation function to apply when filling the cache.
   py::object compileFn_;
 };
@@ -772,7 +851,8 @@ public:
     }
     at::Tensor tensorArgs[NUM_ARGS]; // NOLINT: c-style arrays
     std::copy(args.begin(), args.end(), tensorArgs);
-    py::gil_scoped_acquire guard; // we protect our cache w/ GIL
+    // No GIL here: the cache synchronizes itself and only acquires the GIL
+    // on a compilation miss. See NOTE: [GIL-free cache hits].
     cache_.call(tensorArgs);
     return tensorArgs[LAST_ARG];
   }
@@ -14,6 +14,63 @@
 namespace at {
 namespace functorch {
 
+// NOTE: [TensorWrapper freelist]
+// materializeGradWrappers allocates a TensorWrapper for tensor arguments on
+// essentially every op inside a grad transform, and the back fallback
+// allocates one more per output. Those wrappers die shortly after, so the
+// allocation pattern is a hot alloc/free cycle of identically-sized blocks.
+// Rather than round-tripping through the allocator, keep dead blocks on a
+// thread-local freelist: operator new becomes a pop, operator delete a push.
+// A block may be freed on a different thread than it was allocated on; it
+// just migrates to that thread's list. The list is capped so a burst can't
+// pin memory forever, and remaining blocks are released at thread exit.
+namespace {
+
+struct WrapperFreeBlock {
+  WrapperFreeBlock* next;
+};
+
+struct WrapperFreelist {
+  WrapperFreeBlock* head = nullptr;
+  size_t size = 0;
+
+  ~WrapperFreelist() {
+    while (head != nullptr) {
+      auto* next = head->next;
+      ::operator delete(head);
+      head = next;
+    }
+  }
+};
+
+constexpr size_t kWrapperFreelistMaxSize = 1024;
+thread_local WrapperFreelist wrapperFreelist;
+
+} // namespace
+
+void* TensorWrapper::operator new(size_t size) {
+  auto& freelist = wrapperFreelist;
+  if (size != sizeof(TensorWrapper) || freelist.head == nullptr) {
+    return ::operator new(size);
+  }
+  auto* block = freelist.head;
+  freelist.head = block->next;
+  freelist.size--;
+  return block;
+}
+
+void TensorWrapper::operator delete(void* ptr, size_t size) {
+  auto& freelist = wrapperFreelist;
+  if (size != sizeof(TensorWrapper) || freelist.size >= kWrapperFreelistMaxSize) {
+    ::operator delete(ptr);
+    return;
+  }
+  auto* block = static_cast<WrapperFreeBlock*>(ptr);
+  block->next = freelist.head;
+  freelist.head = block;
+  freelist.size++;
+}
+
 void dumpTensor(std::ostream& ss, const Tensor& tensor) {
   auto* wrapped = maybeGetTensorWrapper(tensor);
   if (!wrapped) {
@@ -64,9 +121,9 @@ c10::intrusive_ptr<TensorWrapper> makeTensorWrapperPtr(const Tensor& tensor, int
   auto key_set = getKeysToPropagateToWrapper(tensor, keys_to_propagate);
   key_set = key_set.add(kGradWrapperKey);
   if (should_be_alive) {
-    return c10::make_intrusive<TensorWrapper>(key_set, tensor, level, getLifeHandleForLevel(level));
+    return c10::make_intrusive<TensorWrapper>(key_set, tensor, level, getGenerationForLevel(level));
   } else {
-    return c10::make_intrusive<TensorWrapper>(key_set, tensor, level, std::make_shared<bool>(false));
+    return c10::make_intrusive<TensorWrapper>(key_set, tensor, level, kDeadGeneration);
   }
 }
 
@@ -80,14 +137,14 @@ Tensor makeTensorWrapper(const Tensor& tensor, int64_t level) {
       DispatchKey::AutogradCPU, DispatchKey::AutogradCUDA, DispatchKey::AutogradXLA});
   auto key_set = getKeysToPropagateToWrapper(tensor, keys_to_propagate);
   key_set = key_set.add(kGradWrapperKey);
-  auto life_handle = getLifeHandleForLevel(level);
-  auto result = at::detail::make_tensor<TensorWrapper>(key_set, tensor, level, std::move(life_handle));
+  auto generation = getGenerationForLevel(level);
+  auto result = at::detail::make_tensor<TensorWrapper>(key_set, tensor, level, generation);
   TORCH_INTERNAL_ASSERT(result.key_set().has(kGradWrapperKey));
   return result;
 }
 
 bool TensorWrapper::is_alive() const {
-  return *is_alive_;
+  return isLevelGenerationAlive(level_, generation_);
 }
 
 c10::intrusive_ptr<TensorImpl> TensorWrapper::shallow_copy_and_detach(
@@ -120,12 +177,12 @@ TensorWrapper::TensorWrapper(
     c10::DispatchKeySet key_set,
     Tensor value,
     int64_t level,
-    std::shared_ptr<bool> is_alive,
+    int64_t generation,
     bool use_value_sizes_strides)
   : TensorImpl(key_set, value.dtype(), value.device())
   , value_(std::move(value))
   , level_(level)
-  , is_alive_(std::move(is_alive))
+  , generation_(generation)
 {
   TORCH_INTERNAL_ASSERT(value_.defined());
 
@@ -160,6 +217,34 @@ TensorWrapper* maybeGetTensorWrapper(const Tensor& tensor) {
   return (TensorWrapper*)(tensor.unsafeGetTensorImpl());
 }
 
+const Tensor& peelWrappedLayers(
+    const Tensor& tensor, optional<int64_t> peel_live_level) {
+  // See NOTE: [Single-pass unwrapping]. Walks value_ references, so no
+  // intermediate Tensor is ever constructed.
+  const Tensor* cur = &tensor;
+  while (true) {
+    auto* wrapper = maybeGetTensorWrapper(*cur);
+    if (!wrapper) {
+      break;
+    }
+    if (wrapper->is_alive()) {
+      if (!peel_live_level.has_value()) {
+        break;
+      }
+      auto wrapper_level = wrapper->level().value();
+      TORCH_INTERNAL_ASSERT(wrapper_level <= *peel_live_level, "escaped?");
+      if (wrapper_level != *peel_live_level) {
+        break;
+      }
+      // At most one live wrapper per level; anything underneath is either
+      // dead or belongs to a lower layer.
+      peel_live_level = nullopt;
+    }
+    cur = &wrapper->value();
+  }
+  return *cur;
+}
+
 void dead_tensor_wrapper_fallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
   auto args_size = op.schema().arguments().size();
   int64_t unwrapped_count = 0;
@@ -172,7 +257,8 @@ void dead_tensor_wrapper_fallback(const c10::OperatorHandle& op, torch::jit::Sta
       return tensor;
     }
     unwrapped_count++;
-    return wrapped->value();
+    // Strip the whole dead chain at once; see NOTE: [Single-pass unwrapping].
+    return peelWrappedLayers(tensor);
   };
 
   foreachTensorInplace(*stack, stack->size() - args_size, stack->size(), unwrapIfDeadAndIncrement);
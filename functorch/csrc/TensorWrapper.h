@@ -16,7 +16,7 @@ struct TORCH_API TensorWrapper : public c10::TensorImpl {
       c10::DispatchKeySet key_set,
       Tensor value,
       int64_t level,
-      std::shared_ptr<bool> is_alive,
+      int64_t generation,
       bool use_value_sizes_strides = true);
 
   // Override a bunch of methods inherited from TensorImpl to return error messages
@@ -26,6 +26,13 @@ struct TORCH_API TensorWrapper : public c10::TensorImpl {
 
   void refreshMetadata();
 
+  // Wrappers are created (and dropped) once per tensor argument and output
+  // per op inside a grad transform, so back them with a thread-local
+  // freelist instead of hitting the allocator each time. See
+  // NOTE: [TensorWrapper freelist]
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   const Tensor& value() const {
     return value_;
   }
@@ -51,15 +58,27 @@ struct TORCH_API TensorWrapper : public c10::TensorImpl {
   Tensor value_;
   int64_t level_;
 
-  // When we exit the level, this wrapper may be marked as "not alive".
-  // Wrappers that are not alive:
+  // When we exit the level, this wrapper becomes "not alive": the level's
+  // entry in levelGenerationTable moves past generation_. Wrappers that
+  // are not alive:
   // 1) May still have autograd metadata on them
   // 2) Forward dispatches to the underlying value()
-  std::shared_ptr<bool> is_alive_;
+  int64_t generation_;
 };
 
 TORCH_API Tensor makeTensorWrapper(const Tensor& tensor, int64_t level);
 TORCH_API TensorWrapper* maybeGetTensorWrapper(const Tensor& tensor);
+
+// NOTE: [Single-pass unwrapping]
+// unwrapIfDead and the per-level unwrap in dynamicLayerBackFallback each
+// strip exactly one wrapper, so a tensor inside grad(vmap(grad(f))) used to
+// pay one unwrap-and-rewrap round trip per layer per op. This instead walks
+// the wrapper chain once, following impl pointers without creating
+// intermediate Tensors: it peels every dead TensorWrapper it meets, plus --
+// when `peel_live_level` is set -- one live wrapper at exactly that level.
+// Returns a reference into the chain, valid as long as `tensor` is.
+TORCH_API const Tensor& peelWrappedLayers(
+    const Tensor& tensor, optional<int64_t> peel_live_level = nullopt);
 TORCH_API void dumpTensor(std::ostream & ss, const Tensor& tensor);
 TORCH_API void dumpTensorCout(const Tensor& tensor);
 
@@ -0,0 +1,182 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <functorch/csrc/TransformTracing.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace at {
+namespace functorch {
+
+namespace {
+
+std::atomic<bool> tracing_enabled{false};
+
+struct TraceEvent {
+  const char* op_name;
+  DispatchKey key;
+  int64_t level;
+  int64_t ts_us;
+  int64_t dur_us;
+};
+
+constexpr size_t kTraceRingSize = 8192;
+
+struct ThreadTraceRing {
+  std::array<TraceEvent, kTraceRingSize> events;
+  // Total events ever recorded on this thread; the ring holds the last
+  // kTraceRingSize of them.
+  size_t count = 0;
+  uint64_t tid = 0;
+
+  ThreadTraceRing();
+  ~ThreadTraceRing();
+};
+
+// Guards the ring registry, the retired-event store, and dumping/clearing.
+// The record path never touches it.
+std::mutex& registryMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::vector<ThreadTraceRing*>& ringRegistry() {
+  static std::vector<ThreadTraceRing*> registry;
+  return registry;
+}
+
+// Events from threads that have exited, so they still show up in dumps.
+std::vector<TraceEvent>& retiredEvents() {
+  static std::vector<TraceEvent> events;
+  return events;
+}
+
+std::vector<uint64_t>& retiredEventTids() {
+  static std::vector<uint64_t> tids;
+  return tids;
+}
+
+uint64_t nextTid() {
+  static std::atomic<uint64_t> next{1};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+ThreadTraceRing::ThreadTraceRing() : tid(nextTid()) {
+  std::lock_guard<std::mutex> guard(registryMutex());
+  ringRegistry().push_back(this);
+}
+
+ThreadTraceRing::~ThreadTraceRing() {
+  std::lock_guard<std::mutex> guard(registryMutex());
+  const auto n = std::min(count, kTraceRingSize);
+  const auto start = count - n;
+  for (size_t i = start; i < count; i++) {
+    retiredEvents().push_back(events[i % kTraceRingSize]);
+    retiredEventTids().push_back(tid);
+  }
+  auto& registry = ringRegistry();
+  for (auto it = registry.begin(); it != registry.end(); ++it) {
+    if (*it == this) {
+      registry.erase(it);
+      break;
+    }
+  }
+}
+
+ThreadTraceRing& localRing() {
+  static thread_local ThreadTraceRing ring;
+  return ring;
+}
+
+int64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void setTransformTracingEnabled(bool enabled) {
+  tracing_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool isTransformTracingEnabled() {
+  return tracing_enabled.load(std::memory_order_relaxed);
+}
+
+TransformTraceGuard::TransformTraceGuard(
+    const char* op_name, DispatchKey key, int64_t level)
+    : enabled_(isTransformTracingEnabled()),
+      op_name_(op_name),
+      key_(key),
+      level_(level),
+      start_us_(enabled_ ? nowUs() : 0) {}
+
+TransformTraceGuard::~TransformTraceGuard() {
+  if (!enabled_) {
+    return;
+  }
+  auto& ring = localRing();
+  auto& event = ring.events[ring.count % kTraceRingSize];
+  event.op_name = op_name_;
+  event.key = key_;
+  event.level = level_;
+  event.ts_us = start_us_;
+  event.dur_us = nowUs() - start_us_;
+  ring.count++;
+}
+
+std::string transformTraceToJson() {
+  std::ostringstream ss;
+  ss << "{\"traceEvents\":[";
+  bool first = true;
+  auto emit = [&](const TraceEvent& event, uint64_t tid) {
+    if (!first) {
+      ss << ",";
+    }
+    first = false;
+    ss << "{\"name\":\"" << event.op_name << "\""
+       << ",\"cat\":\"functorch\",\"ph\":\"X\""
+       << ",\"ts\":" << event.ts_us
+       << ",\"dur\":" << event.dur_us
+       << ",\"pid\":0,\"tid\":" << tid
+       << ",\"args\":{\"key\":\"" << c10::toString(event.key) << "\""
+       << ",\"level\":" << event.level << "}}";
+  };
+
+  std::lock_guard<std::mutex> guard(registryMutex());
+  for (const auto* ring : ringRegistry()) {
+    const auto n = std::min(ring->count, kTraceRingSize);
+    const auto start = ring->count - n;
+    for (size_t i = start; i < ring->count; i++) {
+      emit(ring->events[i % kTraceRingSize], ring->tid);
+    }
+  }
+  const auto& retired = retiredEvents();
+  const auto& retired_tids = retiredEventTids();
+  for (size_t i = 0; i < retired.size(); i++) {
+    emit(retired[i], retired_tids[i]);
+  }
+  ss << "]}";
+  return ss.str();
+}
+
+void clearTransformTrace() {
+  std::lock_guard<std::mutex> guard(registryMutex());
+  for (auto* ring : ringRegistry()) {
+    ring->count = 0;
+  }
+  retiredEvents().clear();
+  retiredEventTids().clear();
+}
+
+}
+} // namespace at
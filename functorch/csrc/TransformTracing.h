@@ -0,0 +1,51 @@
+// Copyright (c) Facebook, Inc. and its affiliates.
+// All rights reserved.
+//
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree.
+#pragma once
+#include <c10/core/DispatchKey.h>
+#include <cstdint>
+#include <string>
+
+namespace at {
+namespace functorch {
+
+// NOTE: [Transform event tracing]
+// Structured replacement for the HAS_TORCH_SHOW_DISPATCH_TRACE printouts:
+// the dynamic layer fallbacks and the sliced vmap fallback record
+// (op name, layer key, level, duration) events into a lock-free
+// thread-local ring buffer when tracing is enabled. The events can be
+// dumped as chrome://tracing JSON from Python, which is how you find out
+// which layer of a vmap(grad(vmap(...))) stack the time goes to without
+// recompiling with trace printouts.
+//
+// Recording never takes a lock: each thread appends to its own ring and a
+// disabled check is one relaxed atomic load. Dumping and clearing take a
+// registry mutex; run them with tracing disabled (or the workload
+// quiesced), since in-flight events on other threads may be dropped.
+
+TORCH_API void setTransformTracingEnabled(bool enabled);
+TORCH_API bool isTransformTracingEnabled();
+
+// Serializes all recorded events (including those from exited threads) as a
+// chrome://tracing "traceEvents" JSON document.
+TORCH_API std::string transformTraceToJson();
+TORCH_API void clearTransformTrace();
+
+// RAII recorder. `op_name` must outlive the trace (operator schema names
+// and string literals qualify).
+struct TORCH_API TransformTraceGuard {
+  TransformTraceGuard(const char* op_name, DispatchKey key, int64_t level);
+  ~TransformTraceGuard();
+
+ private:
+  bool enabled_;
+  const char* op_name_;
+  DispatchKey key_;
+  int64_t level_;
+  int64_t start_us_;
+};
+
+}
+} // namespace at
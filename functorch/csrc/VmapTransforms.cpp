@@ -88,16 +88,38 @@ static std::tuple<int64_t, int64_t> computeFrontBatchDimsFromLevels(std::bitset<
   return std::make_tuple(dim, level);
 }
 
-static Tensor moveDimToFrontAndExpand(Tensor tensor, optional<int64_t> dim, int64_t size) {
+// NOTE: [Single-view physical transforms]
+// The multi-batch transforms run once per argument of every fallback-path
+// op, and chaining view ops (movedim + unsqueeze + expand) allocates one
+// TensorImpl per link. Building the final sizes/strides directly and
+// calling as_strided once makes each argument cost exactly one TensorImpl.
+// The stride of a size-1 dim never affects indexing, so 0 is used where
+// unsqueeze/expand would have picked an arbitrary value.
+static Tensor moveDimToFrontAndExpand(const Tensor& tensor, optional<int64_t> dim, int64_t size) {
+  auto sizes = tensor.sizes();
+  auto strides = tensor.strides();
+  VmapDimVector out_sizes;
+  VmapDimVector out_strides;
+  out_sizes.reserve(sizes.size() + 1);
+  out_strides.reserve(strides.size() + 1);
   if (dim) {
-    tensor = tensor.movedim(*dim, 0);
+    out_sizes.push_back(sizes[*dim]);
+    out_strides.push_back(strides[*dim]);
+    for (const auto d : c10::irange(sizes.size())) {
+      if ((int64_t)d == *dim) {
+        continue;
+      }
+      out_sizes.push_back(sizes[d]);
+      out_strides.push_back(strides[d]);
+    }
   } else {
-    tensor = tensor.unsqueeze(0);
-    auto expanded_sizes = tensor.sizes().vec();
-    expanded_sizes[0] = size;
-    tensor = tensor.expand(expanded_sizes);
+    // Same as unsqueeze(0) + expand: a size-`size` front dim with stride 0.
+    out_sizes.push_back(size);
+    out_strides.push_back(0);
+    out_sizes.append(sizes.begin(), sizes.end());
+    out_strides.append(strides.begin(), strides.end());
   }
-  return tensor;
+  return tensor.as_strided(out_sizes, out_strides);
 }
 
 // The algorithm is as follows:
@@ -148,17 +170,36 @@ MultiBatchVmapTransform::logicalToPhysical(TensorList logical_tensors) {
   return result;
 }
 
-static Tensor moveDimToFrontAndUnsqueeze(Tensor tensor, optional<int64_t> dim, int64_t example_ndim) {
+// See NOTE: [Single-view physical transforms]. This fuses the movedim (or
+// unsqueeze(0)) with the chain of unsqueeze(1) padding calls, which used
+// to allocate a TensorImpl per missing dim.
+static Tensor moveDimToFrontAndUnsqueeze(const Tensor& tensor, optional<int64_t> dim, int64_t example_ndim) {
+  auto sizes = tensor.sizes();
+  auto strides = tensor.strides();
+  auto ndim = dim ? (int64_t)sizes.size() - 1 : (int64_t)sizes.size();
+  VmapDimVector out_sizes;
+  VmapDimVector out_strides;
+  out_sizes.reserve(std::max(example_ndim, ndim) + 1);
+  out_strides.reserve(std::max(example_ndim, ndim) + 1);
   if (dim) {
-    tensor = tensor.movedim(*dim, 0);
+    out_sizes.push_back(sizes[*dim]);
+    out_strides.push_back(strides[*dim]);
   } else {
-    tensor = tensor.unsqueeze(0);
+    out_sizes.push_back(1);
+    out_strides.push_back(0);
   }
-  auto ndim = tensor.dim() - 1;
   for (int64_t i = 0; i < example_ndim - ndim; i++) {
-    tensor = tensor.unsqueeze(1);
+    out_sizes.push_back(1);
+    out_strides.push_back(0);
+  }
+  for (const auto d : c10::irange(sizes.size())) {
+    if (dim && (int64_t)d == *dim) {
+      continue;
+    }
+    out_sizes.push_back(sizes[d]);
+    out_strides.push_back(strides[d]);
   }
-  return tensor;
+  return tensor.as_strided(out_sizes, out_strides);
 }
 
 VmapPhysicalViewVec BroadcastingVmapTransform::logicalToPhysical(TensorList logical_tensors) {
@@ -6,16 +6,21 @@
 
 #include <torch/extension.h>
 #include <ATen/WrapDimUtils.h>
+#include <c10/util/irange.h>
 
 #include <functorch/csrc/TensorWrapper.h>
 #include <functorch/csrc/DynamicLayer.h>
 #include <functorch/csrc/BatchedTensorImpl.h>
 #include <functorch/csrc/VmapTransforms.h>
 #include <functorch/csrc/BatchedFallback.h>
+#include <functorch/csrc/Decompositions.h>
 #include <functorch/csrc/BatchRulesHelper.h>
 #include <functorch/csrc/PointwiseOperatorCompileCache.h>
 #include <functorch/csrc/CompileCache.h>
 #include <functorch/csrc/CustomFunction.h>
+#include <functorch/csrc/TransformTracing.h>
+#include <functorch/csrc/DispatchBenchmark.h>
+#include <functorch/csrc/MinCut.h>
 
 
 namespace at {
@@ -99,6 +104,76 @@ Tensor _remove_batch_dim(const Tensor& self, int64_t level, int64_t batch_size,
   return result;
 }
 
+// Bulk variants of _add_batch_dim/_remove_batch_dim. vmap in Python flattens
+// its inputs and outputs into flat lists of leaves anyway; these take the
+// whole flat list so a vmapped call does one Python -> C++ crossing per
+// direction instead of one per pytree leaf.
+
+// Validates that all args-to-be-batched share the same batch size and
+// returns it. `in_dims` entries that are None mean "not batched".
+int64_t _validate_and_get_batch_size(
+    const std::vector<Tensor>& tensors,
+    const std::vector<c10::optional<int64_t>>& in_dims) {
+  TORCH_CHECK(tensors.size() == in_dims.size(),
+      "vmap: expected one in_dim per input tensor, got ",
+      tensors.size(), " tensors and ", in_dims.size(), " in_dims");
+  int64_t batch_size = -1;
+  for (const auto idx : c10::irange(0, tensors.size())) {
+    if (!in_dims[idx].has_value()) {
+      continue;
+    }
+    const auto size = tensors[idx].size(*in_dims[idx]);
+    if (batch_size == -1) {
+      batch_size = size;
+      continue;
+    }
+    // TORCH_CHECK_VALUE so this surfaces in Python as a ValueError, like
+    // the Python-side validation it replaced.
+    TORCH_CHECK_VALUE(size == batch_size,
+        "vmap: Expected all tensors to have the same size in the mapped "
+        "dimension, got sizes ", batch_size, " and ", size,
+        " for the mapped dimension");
+  }
+  TORCH_CHECK(batch_size != -1,
+      "vmap: Expected at least one input with a mapped dimension");
+  return batch_size;
+}
+
+std::vector<Tensor> _add_batch_dims(
+    const std::vector<Tensor>& tensors,
+    const std::vector<c10::optional<int64_t>>& in_dims,
+    int64_t level) {
+  TORCH_CHECK(tensors.size() == in_dims.size(),
+      "vmap: expected one in_dim per input tensor, got ",
+      tensors.size(), " tensors and ", in_dims.size(), " in_dims");
+  std::vector<Tensor> results;
+  results.reserve(tensors.size());
+  for (const auto idx : c10::irange(0, tensors.size())) {
+    if (!in_dims[idx].has_value()) {
+      results.push_back(tensors[idx]);
+      continue;
+    }
+    results.push_back(addBatchDim(tensors[idx], *in_dims[idx], level));
+  }
+  return results;
+}
+
+std::vector<Tensor> _remove_batch_dims(
+    const std::vector<Tensor>& tensors,
+    int64_t level,
+    int64_t batch_size,
+    const std::vector<int64_t>& out_dims) {
+  TORCH_CHECK(tensors.size() == out_dims.size(),
+      "vmap: expected one out_dim per output tensor, got ",
+      tensors.size(), " tensors and ", out_dims.size(), " out_dims");
+  std::vector<Tensor> results;
+  results.reserve(tensors.size());
+  for (const auto idx : c10::irange(0, tensors.size())) {
+    results.push_back(_remove_batch_dim(tensors[idx], level, batch_size, out_dims[idx]));
+  }
+  return results;
+}
+
 Tensor _wrap_for_grad(const Tensor& self, int64_t level) {
   // NB: different behavior inside??
   // return self;
@@ -119,6 +194,41 @@ Tensor _unwrap_for_grad(const Tensor& self, int64_t level) {
   return self;
 }
 
+// NOTE: [Bulk grad wrapping]
+// grad/vjp used to make one Python->C++ round trip per tensor leaf to wrap
+// inputs, mark them differentiable, and unwrap outputs, which dominated the
+// cost of small losses called at high rates. These variants take flat
+// tensor lists so a transform entry costs a fixed number of native calls
+// regardless of leaf count -- the grad-side analogue of _add_batch_dims /
+// _remove_batch_dims.
+std::vector<Tensor> _wrap_for_grad_bulk(
+    const std::vector<Tensor>& tensors, int64_t level) {
+  std::vector<Tensor> results;
+  results.reserve(tensors.size());
+  for (const auto& tensor : tensors) {
+    results.push_back(_wrap_for_grad(tensor, level));
+  }
+  return results;
+}
+
+std::vector<Tensor> _unwrap_for_grad_bulk(
+    const std::vector<Tensor>& tensors, int64_t level) {
+  std::vector<Tensor> results;
+  results.reserve(tensors.size());
+  for (const auto& tensor : tensors) {
+    results.push_back(_unwrap_for_grad(tensor, level));
+  }
+  return results;
+}
+
+// In-place bulk version of create_differentiable; the wrappers are mutated,
+// so there is nothing to return.
+void _set_tensors_requires_grad(const std::vector<Tensor>& tensors) {
+  for (const auto& tensor : tensors) {
+    tensor.set_requires_grad(true);
+  }
+}
+
 int64_t dlevel(const Tensor& tensor) {
   auto* wrapped = maybeGetTensorWrapper(tensor);
   if (!wrapped) {
@@ -159,6 +269,82 @@ int64_t _grad_decrement_nesting() {
   return layer.layerId();
 }
 
+// See NOTE: [Bulk grad wrapping]: pushes a grad level and wraps all the
+// given tensors at it in a single native call.
+std::tuple<int64_t, std::vector<Tensor>> _grad_increment_nesting_and_wrap(
+    const std::vector<Tensor>& tensors) {
+  const auto level = _grad_increment_nesting();
+  // Callers enter their try/finally only after this returns, so pop the
+  // layer ourselves if wrapping throws; leaking the level would corrupt
+  // every subsequent transform in the process.
+  try {
+    return std::make_tuple(level, _wrap_for_grad_bulk(tensors, level));
+  } catch (...) {
+    _grad_decrement_nesting();
+    throw;
+  }
+}
+
+// NOTE: [Native jacobian assembly]
+// jacrev/jacfwd post-process the vmapped vjp/jvp results in Python with one
+// split + view per (input, output) pair; for functions with many parameter
+// leaves that loop costs as much as the transformed calls themselves. The
+// packed tensor vmap returns for each input (resp. output) already holds the
+// whole jacobian row, so the final blocks are just views into it -- these
+// helpers carve out all of the views in a single native call. No data is
+// copied and nothing is stacked.
+std::vector<std::vector<Tensor>> _assemble_jacrev_blocks(
+    const std::vector<Tensor>& results,
+    const std::vector<int64_t>& output_numels,
+    const std::vector<std::vector<int64_t>>& output_shapes) {
+  TORCH_INTERNAL_ASSERT(output_numels.size() == output_shapes.size());
+  // Outputs-major, matching the structure jacrev returns.
+  std::vector<std::vector<Tensor>> blocks(output_shapes.size());
+  for (auto& row : blocks) {
+    row.reserve(results.size());
+  }
+  for (const auto& result : results) {
+    // result packs the cotangents for one input: [sum(output_numels), *input_shape]
+    const auto input_shape = result.sizes().slice(1);
+    int64_t offset = 0;
+    for (const auto j : c10::irange(output_numels.size())) {
+      std::vector<int64_t> shape(output_shapes[j].begin(), output_shapes[j].end());
+      shape.insert(shape.end(), input_shape.begin(), input_shape.end());
+      blocks[j].push_back(result.narrow(0, offset, output_numels[j]).view(shape));
+      offset += output_numels[j];
+    }
+  }
+  return blocks;
+}
+
+std::vector<std::vector<Tensor>> _assemble_jacfwd_blocks(
+    const std::vector<Tensor>& jac_outs,
+    const std::vector<int64_t>& primal_numels,
+    const std::vector<std::vector<int64_t>>& primal_shapes) {
+  TORCH_INTERNAL_ASSERT(primal_numels.size() == primal_shapes.size());
+  std::vector<std::vector<Tensor>> blocks;
+  blocks.reserve(jac_outs.size());
+  for (const auto& jac_out : jac_outs) {
+    // jac_out packs the tangents for one output: [sum(primal_numels), *output_shape]
+    const auto moved = jac_out.movedim(0, -1);
+    const auto last_dim = moved.dim() - 1;
+    std::vector<Tensor> row;
+    row.reserve(primal_numels.size());
+    int64_t offset = 0;
+    for (const auto j : c10::irange(primal_numels.size())) {
+      const auto block = moved.narrow(last_dim, offset, primal_numels[j]);
+      offset += primal_numels[j];
+      // Splitting a single dim is always viewable, so this reshape never
+      // copies. A scalar primal drops its size-1 dim, like safe_unflatten.
+      std::vector<int64_t> shape(moved.sizes().begin(), moved.sizes().end() - 1);
+      shape.insert(shape.end(), primal_shapes[j].begin(), primal_shapes[j].end());
+      row.push_back(block.reshape(shape));
+    }
+    blocks.push_back(std::move(row));
+  }
+  return blocks;
+}
+
 int64_t _vmap_increment_nesting(int64_t batch_size, const std::string& randomness) {
   return initAndPushDynamicLayer(kBatchedKey, batch_size, get_randomness_enum(randomness));
 }
@@ -264,15 +450,132 @@ namespace at { namespace functorch {
 PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
   m.def("_add_batch_dim", &at::functorch::_add_batch_dim, "add batch dim");
   m.def("_remove_batch_dim", &at::functorch::_remove_batch_dim, "remove batch dim");
+  m.def("_validate_and_get_batch_size", &at::functorch::_validate_and_get_batch_size,
+        "validate batched inputs and return the batch size");
+  m.def("_add_batch_dims", &at::functorch::_add_batch_dims, "add batch dims to a flat list of tensors");
+  m.def("_remove_batch_dims", &at::functorch::_remove_batch_dims, "remove batch dims from a flat list of tensors");
   m.def("_vmap_increment_nesting", &at::functorch::_vmap_increment_nesting, "remove batch dim");
   m.def("_vmap_decrement_nesting", &at::functorch::_vmap_decrement_nesting, "remove batch dim");
   m.def("_grad_increment_nesting", &at::functorch::_grad_increment_nesting, "remove batch dim");
   m.def("_grad_decrement_nesting", &at::functorch::_grad_decrement_nesting, "remove batch dim");
   m.def("_wrap_for_grad", &at::functorch::_wrap_for_grad, "wrap as gradtrackingtensor");
+  // See NOTE: [Bulk grad wrapping]
+  m.def("_wrap_for_grad_bulk", &at::functorch::_wrap_for_grad_bulk);
+  m.def("_unwrap_for_grad_bulk", &at::functorch::_unwrap_for_grad_bulk);
+  m.def("_set_tensors_requires_grad", &at::functorch::_set_tensors_requires_grad);
+  m.def("_grad_increment_nesting_and_wrap", &at::functorch::_grad_increment_nesting_and_wrap);
+  // See NOTE: [Native jacobian assembly]
+  m.def("_assemble_jacrev_blocks", &at::functorch::_assemble_jacrev_blocks);
+  m.def("_assemble_jacfwd_blocks", &at::functorch::_assemble_jacfwd_blocks);
   m.def("_unwrap_for_grad", &at::functorch::_unwrap_for_grad, "unwrap from gradtrackingtensor");
   m.def("_set_vmap_fallback_warning_enabled", &at::functorch::setVmapFallbackWarningEnabled, "Set vmap fallback warnings");
   m.def("_set_vmap_fallback_enabled", &at::functorch::setVmapFallbackEnabled);
   m.def("_is_vmap_fallback_enabled", &at::functorch::isVmapFallbackEnabled);
+  m.def("_set_vmap_fallback_parallel_enabled", &at::functorch::setVmapFallbackParallelEnabled);
+  m.def("_is_vmap_fallback_parallel_enabled", &at::functorch::isVmapFallbackParallelEnabled);
+  m.def("_set_vmap_fallback_preallocate_outputs_enabled", &at::functorch::setVmapFallbackPreallocateOutputsEnabled);
+  m.def("_is_vmap_fallback_preallocate_outputs_enabled", &at::functorch::isVmapFallbackPreallocateOutputsEnabled);
+  // See NOTE: [Runtime decomposition registry]
+  m.def("_set_vmap_fallback_decompose_enabled", &at::functorch::setVmapFallbackDecomposeEnabled);
+  m.def("_is_vmap_fallback_decompose_enabled", &at::functorch::isVmapFallbackDecomposeEnabled);
+  m.def("_decomposition_registry_ops", &at::functorch::decompositionRegistryOps);
+  m.def("_run_native_decomposition",
+        [](const std::string& name, py::args args, py::kwargs kwargs) -> py::object {
+    // Resolve the overload the way torch.ops does: try each registered
+    // overload's schema until the arguments convert.
+    auto& dispatcher = c10::Dispatcher::singleton();
+    for (const auto& qualname : at::functorch::decompositionRegistryOps()) {
+      auto op_name = c10::OperatorName(
+          qualname.substr(0, qualname.find('.')),
+          qualname.find('.') == std::string::npos ? "" : qualname.substr(qualname.find('.') + 1));
+      if (op_name.name != name) {
+        continue;
+      }
+      auto op = dispatcher.findSchemaOrThrow(
+          op_name.name.c_str(), op_name.overload_name.c_str());
+      torch::jit::Stack stack;
+      try {
+        stack = torch::jit::createStackForSchema(
+            op.schema(), args, kwargs, c10::nullopt);
+      } catch (const std::exception&) {
+        continue;
+      }
+      TORCH_INTERNAL_ASSERT(at::functorch::runDecomposition(op, &stack));
+      return torch::jit::createPyObjectForStack(std::move(stack));
+    }
+    TORCH_CHECK(false, "_run_native_decomposition: no registered decomposition for ",
+                name, " matches the given arguments");
+  });
+  // See NOTE: [Streamed CUDA fallback]
+  m.def("_set_vmap_fallback_streams_enabled", &at::functorch::setVmapFallbackStreamsEnabled);
+  m.def("_is_vmap_fallback_streams_enabled", &at::functorch::isVmapFallbackStreamsEnabled);
+  m.def("_vmap_fallback_stats", []() {
+    // Snapshot of the per-op fallback counters: {op name: {counter: value}}
+    py::dict result;
+    for (const auto& kv : at::functorch::getVmapFallbackStats()) {
+      py::dict entry;
+      entry["num_calls"] = kv.second.num_calls;
+      entry["total_ns"] = kv.second.total_ns;
+      entry["total_batches"] = kv.second.total_batches;
+      entry["max_batch_size"] = kv.second.max_batch_size;
+      result[py::str(kv.first)] = entry;
+    }
+    return result;
+  });
+  m.def("_reset_vmap_fallback_stats", &at::functorch::resetVmapFallbackStats);
+  // See NOTE: [Transform event tracing]
+  m.def("_set_transform_tracing_enabled", &at::functorch::setTransformTracingEnabled);
+  m.def("_is_transform_tracing_enabled", &at::functorch::isTransformTracingEnabled);
+  m.def("_transform_trace_json", &at::functorch::transformTraceToJson);
+  m.def("_clear_transform_trace", &at::functorch::clearTransformTrace);
+  // See NOTE: [Dispatch overhead microbenchmarks]
+  m.def("_dispatch_overhead_benchmarks", [](int64_t iters) {
+    py::dict result;
+    for (const auto& kv : at::functorch::runDispatchOverheadBenchmarks(iters)) {
+      result[py::str(kv.first)] = kv.second;
+    }
+    return result;
+  }, py::arg("iters") = 100000);
+  // See NOTE: [Native min-cut max-flow]
+  m.def("_min_cut_reachable", &at::functorch::minCutReachable);
+  // NOTE: [C++ module state swap]
+  // Fast path for FunctionalModule(WithBuffers): installs each value
+  // directly into the paired submodule __dict__ (instance attributes win
+  // over the _parameters/_buffers fallbacks in nn.Module.__getattr__) and
+  // returns the previous entries, so calling it again with the returned
+  // list restores the module. None means "no entry": it is returned for
+  // keys that were absent and deletes the key when passed back in. One C
+  // call replaces hundreds of Python setattr/delattr round trips per
+  // stateless forward.
+  m.def("_swap_module_attrs",
+        [](const py::list& dicts, const py::list& names, const py::list& values) {
+    const auto n = py::len(dicts);
+    TORCH_CHECK(py::len(names) == n && py::len(values) == n,
+                "_swap_module_attrs: expected lists of equal length");
+    py::list old_values(n);
+    for (size_t i = 0; i < n; i++) {
+      PyObject* dict = dicts[i].ptr();
+      TORCH_CHECK(PyDict_Check(dict),
+                  "_swap_module_attrs: expected a list of module __dict__s");
+      PyObject* name = names[i].ptr();
+      PyObject* value = values[i].ptr();
+      PyObject* prev = PyDict_GetItemWithError(dict, name);
+      if (prev == nullptr && PyErr_Occurred()) {
+        throw py::error_already_set();
+      }
+      old_values[i] = prev == nullptr
+          ? py::object(py::none())
+          : py::reinterpret_borrow<py::object>(prev);
+      if (value == Py_None) {
+        if (prev != nullptr && PyDict_DelItem(dict, name) != 0) {
+          throw py::error_already_set();
+        }
+      } else if (PyDict_SetItem(dict, name, value) != 0) {
+        throw py::error_already_set();
+      }
+    }
+    return old_values;
+  });
   m.def("dlevel", &at::functorch::dlevel, "dlevel");
   m.def("dump_tensor", &at::functorch::dump_tensor, "dump_tensor");
   m.def("reshape_dim_into", &at::functorch::reshape_dim_into);
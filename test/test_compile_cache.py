@@ -1,3 +1,5 @@
+import unittest
+
 import torch
 
 import functorch
@@ -81,6 +83,48 @@ class TestCompileCache(TestCase):
             elif hasher_type == "StaticShapeHasher":
                 assert total_recomps == 20
 
+    def test_compilation_for_bucketed_shape(self):
+        def fn(x, bias):
+            return x + bias
+
+        functorch.compile.clear_compile_cache()
+        functorch._C._compile_cache_set_shape_bucket_boundaries([16, 64])
+        try:
+            start_num_recomps = functorch.compile.num_of_recompilations()
+            aot_autograd_fn = aot_function(
+                fn, nop, nop, hasher_type="BucketedShapeHasher"
+            )
+
+            # All of these fall into the (1, 16] bucket: one compilation.
+            for s in range(9, 17):
+                a = torch.randn(s, requires_grad=True)
+                b = torch.randn(s, requires_grad=True)
+                self.check(a, b, aot_autograd_fn, fn)
+
+            end_num_recomps = functorch.compile.num_of_recompilations()
+            assert end_num_recomps - start_num_recomps == 1
+
+            # Crossing into the (16, 64] bucket recompiles exactly once.
+            for s in range(17, 65, 16):
+                a = torch.randn(s, requires_grad=True)
+                b = torch.randn(s, requires_grad=True)
+                self.check(a, b, aot_autograd_fn, fn)
+
+            end_num_recomps = functorch.compile.num_of_recompilations()
+            assert end_num_recomps - start_num_recomps == 2
+
+            # Past the last boundary, buckets fall back to powers of two:
+            # both of these land in the (64, 128] bucket.
+            for s in [100, 120]:
+                a = torch.randn(s, requires_grad=True)
+                b = torch.randn(s, requires_grad=True)
+                self.check(a, b, aot_autograd_fn, fn)
+
+            end_num_recomps = functorch.compile.num_of_recompilations()
+            assert end_num_recomps - start_num_recomps == 3
+        finally:
+            functorch._C._compile_cache_set_shape_bucket_boundaries([])
+
     def test_global_cache_no_recompilations(self):
         def f(x, bias):
             return x + bias
@@ -183,6 +227,63 @@ class TestCompileCache(TestCase):
             total_recomps = end_num_recomps - start_num_recomps
             assert total_recomps == 2
 
+    def test_compiled_vmap(self):
+        # See NOTE: [Compiled vmap]
+        def fn(x, y):
+            return (x * y).sin() + x
+
+        for hasher_type in ["DynamicShapeHasher", "StaticShapeHasher"]:
+            functorch.compile.clear_compile_cache()
+            start_num_recomps = functorch.compile.num_of_recompilations()
+            compiled_vmap_fn = functorch.compile.compiled_vmap(
+                fn, hasher_type=hasher_type
+            )
+
+            a = torch.randn(8, 10)
+            b = torch.randn(8, 10)
+            ref = functorch.vmap(fn)(a, b)
+            # The second call replays the cached batched graph.
+            for _ in range(2):
+                res = compiled_vmap_fn(a, b)
+                assert torch.allclose(res, ref)
+
+            end_num_recomps = functorch.compile.num_of_recompilations()
+            total_recomps = end_num_recomps - start_num_recomps
+            assert total_recomps == 1
+
+            # in_dims participates in the cache key
+            compiled_vmap_t = functorch.compile.compiled_vmap(
+                fn, in_dims=(1, 1), hasher_type=hasher_type
+            )
+            ref = functorch.vmap(fn, in_dims=(1, 1))(a, b)
+            res = compiled_vmap_t(a, b)
+            assert torch.allclose(res, ref)
+
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA not available")
+    def test_cudagraphify(self):
+        # See NOTE: [CUDA graph replay]
+        def fn(x, y):
+            return (x * y).sin() + x
+
+        functorch.compile.clear_compile_cache()
+        start_num_recomps = functorch.compile.num_of_recompilations()
+        graphed_fn = functorch.compile.cudagraphify(fn)
+
+        a = torch.randn(8, 10, device="cuda")
+        b = torch.randn(8, 10, device="cuda")
+        ref = fn(a, b)
+        res = graphed_fn(a, b)
+        assert torch.allclose(res, ref)
+
+        # New values at the same specialization replay without recapture
+        # and reflect the copied-in inputs.
+        a2 = torch.randn(8, 10, device="cuda")
+        res = graphed_fn(a2, b)
+        assert torch.allclose(res, fn(a2, b))
+
+        end_num_recomps = functorch.compile.num_of_recompilations()
+        assert end_num_recomps - start_num_recomps == 1
+
 
 class TestCompileCacheStaticArgs(TestCase):
     def check(self, a, b, aot_autograd_fn, fn):
@@ -2,7 +2,7 @@ import torch
 import unittest
 
 from torch import fx
-from functorch.compile import pointwise_operator
+from functorch.compile import pointwise_operator, reduction_operator
 from torch.testing._internal.common_utils import run_tests
 from torch.testing._internal.jit_utils import JitTestCase
 
@@ -112,6 +112,19 @@ class TestOperatorAuthoring(JitTestCase):
     def test_torch_function(self):
         self.check(self.rand(10), TorchFunctionExample())
 
+    def test_threaded_cache_hits(self):
+        # Cache probes take a reader lock instead of the GIL; see
+        # NOTE: [GIL-free cache hits]. Hammer the hit path from many threads.
+        from concurrent.futures import ThreadPoolExecutor
+        a = self.rand(1024)
+        b = self.rand(1024)
+        expected = pointwise_fn(a, b)
+        nnc_pointwise_fn(a, b)  # warm the cache
+        with ThreadPoolExecutor(max_workers=8) as pool:
+            results = list(pool.map(lambda _: nnc_pointwise_fn(a, b), range(64)))
+        for result in results:
+            torch.testing.assert_allclose(result, expected)
+
     def test_fx_trace(self):
         def example(x):
             return custom1(custom2(x))
@@ -222,6 +235,63 @@ class TestOperatorAuthoring(JitTestCase):
             res = pointwise_fn(a, b)
             assert torch.allclose(ref, res, atol=1e-3, rtol=1e-3)
 
+    def check_reduction(self, op, ref_fn, *args):
+        ref = ref_fn(*args)
+        res = op(*args)
+        self.assertEqual(res.dtype, ref.dtype)
+        self.assertEqual(res.size(), ref.size())
+        torch.testing.assert_allclose(ref, res)
+
+    @unittest.skipIf(not LLVM_ENABLED, "reductions are CPU/LLVM only")
+    def test_reduction_sum(self):
+        @reduction_operator
+        def mul_sum(a, b):
+            return a * b
+
+        self.check_reduction(
+            mul_sum,
+            lambda a, b: (a * b).sum(-1),
+            torch.rand(8, 16),
+            torch.rand(8, 16),
+        )
+
+    @unittest.skipIf(not LLVM_ENABLED, "reductions are CPU/LLVM only")
+    def test_reduction_mean_broadcast(self):
+        @reduction_operator(reduction="mean")
+        def add_mean(a, b):
+            return a + b
+
+        self.check_reduction(
+            add_mean,
+            lambda a, b: (a + b).mean(-1),
+            torch.rand(8, 16),
+            torch.rand(1, 16),
+        )
+
+    @unittest.skipIf(not LLVM_ENABLED, "reductions are CPU/LLVM only")
+    def test_reduction_max_2d(self):
+        @reduction_operator(reduction="max", num_reduce_dims=2)
+        def id_max(a):
+            return a
+
+        self.check_reduction(
+            id_max,
+            lambda a: a.amax((-2, -1)),
+            torch.rand(4, 8, 16),
+        )
+
+    @unittest.skipIf(not LLVM_ENABLED, "reductions are CPU/LLVM only")
+    def test_reduction_epilogue(self):
+        @reduction_operator(reduction="sum", epilogue=torch.log)
+        def logsum(a):
+            return torch.exp(a)
+
+        self.check_reduction(
+            logsum,
+            lambda a: a.exp().sum(-1).log(),
+            torch.rand(8, 16),
+        )
+
     def test_bias_gelu(self):
         def bias_gelu(bias, y):
             x = bias + y
@@ -289,6 +289,70 @@ class TestVmapAPI(TestCase):
         result = vmap(foo, out_dims=(1,))(tensor)
         self.assertEqual(result, expected)
 
+    def test_chunk_size(self):
+        def foo(x, y):
+            return x.sin() + y
+
+        x = torch.randn(7, 3)
+        y = torch.randn(3)
+        expected = vmap(foo, in_dims=(0, None))(x, y)
+        # chunk_size that divides the batch, that doesn't, and one bigger
+        # than the batch (which should be equivalent to no chunking)
+        for chunk_size in [1, 2, 7, 100]:
+            result = vmap(foo, in_dims=(0, None), chunk_size=chunk_size)(x, y)
+            self.assertEqual(result, expected)
+
+    def test_chunk_size_out_dims(self):
+        def foo(x):
+            return x.sin(), x.cos()
+
+        x = torch.randn(5, 2, 3)
+        expected = vmap(foo, in_dims=1, out_dims=(0, 1))(x)
+        result = vmap(foo, in_dims=1, out_dims=(0, 1), chunk_size=2)(x)
+        self.assertEqual(result, expected)
+
+    def test_chunk_size_invalid(self):
+        with self.assertRaisesRegex(ValueError, 'chunk_size'):
+            vmap(torch.sin, chunk_size=0)
+        with self.assertRaisesRegex(ValueError, 'chunk_size'):
+            vmap(torch.sin, chunk_size=-1)
+        with self.assertRaisesRegex(ValueError, "randomness='same'"):
+            vmap(torch.sin, chunk_size=2, randomness='same')
+
+    @skipIf(not torch.cuda.is_available(), "CUDA is unavailable")
+    def test_devices(self):
+        # See NOTE: [Device-sharded vmap]. Listing the same device twice
+        # still exercises the shard/stream/gather path on one GPU; on a
+        # multi-GPU host, use both.
+        def foo(x, y):
+            return x.sin() + y
+
+        devices = ['cuda:0', 'cuda:0']
+        if torch.cuda.device_count() > 1:
+            devices = ['cuda:0', 'cuda:1']
+
+        x = torch.randn(7, 3, device='cuda:0')
+        y = torch.randn(3, device='cuda:0')
+        expected = vmap(foo, in_dims=(0, None))(x, y)
+        result = vmap(foo, in_dims=(0, None), devices=devices)(x, y)
+        self.assertEqual(result, expected)
+        self.assertEqual(result.device, x.device)
+
+        # CPU inputs get sharded out and gathered back
+        x_cpu, y_cpu = x.cpu(), y.cpu()
+        result = vmap(foo, in_dims=(0, None), devices=devices)(x_cpu, y_cpu)
+        self.assertEqual(result, expected.cpu())
+
+    def test_devices_invalid(self):
+        with self.assertRaisesRegex(ValueError, 'devices'):
+            vmap(torch.sin, devices=[])
+        with self.assertRaisesRegex(ValueError, 'devices'):
+            vmap(torch.sin, devices=['cpu'])
+        with self.assertRaisesRegex(ValueError, 'chunk_size and devices'):
+            vmap(torch.sin, chunk_size=2, devices=['cuda:0'])
+        with self.assertRaisesRegex(ValueError, "randomness='same'"):
+            vmap(torch.sin, devices=['cuda:0'], randomness='same')
+
     def test_pytree_returns(self):
         x = torch.randn(2, 3)
 
@@ -693,6 +757,89 @@ class TestVmapAPI(TestCase):
         result = vmap(vmap(vmap(op)))(x, y)
         self.assertEqual(result, op(x, y.view(100, 10, 10, 1)))
 
+    def test_fallback_preallocate_outputs(self):
+        # NB: One day we will implement batching rules for torch.copysign and
+        # torch.var_mean. If/when we do, this test should be switched to
+        # other fallback ops to avoid bitrot.
+        prev = functorch._C._is_vmap_fallback_preallocate_outputs_enabled()
+        functorch._C._set_vmap_fallback_preallocate_outputs_enabled(True)
+        try:
+            op = torch.copysign
+            x = torch.randn(7, 11, 5)
+            y = torch.randn(5, 7, 11)
+            result = vmap(op, (2, 0))(x, y)
+            self.assertEqual(result, op(x.permute(2, 0, 1), y))
+
+            # multiple outputs, nested vmap
+            tensor = torch.randn(2, 3, 10)
+            result = vmap(vmap(torch.var_mean))(tensor)
+            expected = torch.var_mean(tensor, dim=2)
+            self.assertEqual(result, expected)
+        finally:
+            functorch._C._set_vmap_fallback_preallocate_outputs_enabled(prev)
+
+    def test_fallback_decompose(self):
+        # NB: One day we will implement a batching rule for torch.copysign.
+        # If/when we do, the registry entry in Decompositions.cpp goes away
+        # and this test should move to another registered op.
+        prev = functorch._C._is_vmap_fallback_decompose_enabled()
+        functorch._C._set_vmap_fallback_decompose_enabled(True)
+        try:
+            op = torch.copysign
+            x = torch.randn(5, 7)
+            y = torch.randn(5, 7)
+            # The decomposed path never slices, so no fallback warning fires.
+            with warnings.catch_warnings():
+                warnings.simplefilter("error")
+                result = vmap(op)(x, y)
+            self.assertEqual(result, op(x, y))
+
+            # Scalar overload, negative zero sign
+            result = vmap(lambda t: op(t, -0.0))(x)
+            self.assertEqual(result, op(x, -0.0))
+
+            # nested vmap
+            x = torch.randn(7, 11, 5)
+            y = torch.randn(5, 7, 11)
+            result = vmap(vmap(op), (2, 0))(x, y)
+            self.assertEqual(result, op(x.permute(2, 0, 1), y))
+        finally:
+            functorch._C._set_vmap_fallback_decompose_enabled(prev)
+
+    @skipIf(not torch.cuda.is_available(), "CUDA is unavailable")
+    def test_fallback_streams(self):
+        # NB: One day we will implement batching rules for torch.copysign and
+        # torch.var_mean. If/when we do, this test should be switched to
+        # other fallback ops to avoid bitrot.
+        prev = functorch._C._is_vmap_fallback_streams_enabled()
+        functorch._C._set_vmap_fallback_streams_enabled(True)
+        try:
+            op = torch.copysign
+            x = torch.randn(7, 11, 5, device='cuda')
+            y = torch.randn(5, 7, 11, device='cuda')
+            result = vmap(op, (2, 0))(x, y)
+            self.assertEqual(result, op(x.permute(2, 0, 1), y))
+
+            # multiple outputs, nested vmap
+            tensor = torch.randn(2, 3, 10, device='cuda')
+            result = vmap(vmap(torch.var_mean))(tensor)
+            expected = torch.var_mean(tensor, dim=2)
+            self.assertEqual(result, expected)
+
+            # batch size smaller than the stream pool
+            x = torch.randn(2, 5, device='cuda')
+            y = torch.randn(2, 5, device='cuda')
+            result = vmap(op)(x, y)
+            self.assertEqual(result, op(x, y))
+
+            # CPU tensors take the regular preallocated path
+            x = torch.randn(3, 5)
+            y = torch.randn(3, 5)
+            result = vmap(op)(x, y)
+            self.assertEqual(result, op(x, y))
+        finally:
+            functorch._C._set_vmap_fallback_streams_enabled(prev)
+
     # TODO: No clue what is wrong here.
     @unittest.skip
     def test_fallback_masked_fill(self):